@@ -0,0 +1,88 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/adaptive_page_size.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+namespace google {
+namespace gax {
+
+namespace {
+// The weight of the newest sample in the moving averages.
+constexpr double kSmoothing = 0.3;
+
+double Average(double average, double sample) {
+  return average < 0 ? sample : average + kSmoothing * (sample - average);
+}
+}  // namespace
+
+AdaptivePageSize::AdaptivePageSize(AdaptivePageSizeOptions options)
+    : options_(std::move(options)),
+      page_size_(0),
+      latency_us_(-1),
+      processing_us_(-1) {
+  page_size_ = Clamp(options_.initial_page_size);
+}
+
+int AdaptivePageSize::PageSize() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return page_size_;
+}
+
+void AdaptivePageSize::OnPageFetched(std::chrono::microseconds latency,
+                                     std::size_t bytes) {
+  double max_latency = static_cast<double>(options_.max_page_latency.count());
+  double max_bytes = static_cast<double>(options_.max_page_bytes);
+  double page_latency = static_cast<double>(latency.count());
+  double page_bytes = static_cast<double>(bytes);
+
+  std::lock_guard<std::mutex> lk(mu_);
+  latency_us_ = Average(latency_us_, page_latency);
+  // React to a single oversized or slow page right away, in proportion to
+  // how far it is over the limit.
+  if (page_bytes > max_bytes || page_latency > max_latency) {
+    double factor = (std::min)(max_bytes / page_bytes,
+                               max_latency / (std::max)(page_latency, 1.0));
+    page_size_ = Clamp((std::min)(page_size_ * factor, page_size_ - 1.0));
+    return;
+  }
+  // Only grow while the caller is waiting for pages, and while a page twice
+  // as large is expected to stay within the limits.
+  bool fetch_bound = processing_us_ < 0 || processing_us_ < latency_us_;
+  if (fetch_bound && 2 * page_bytes <= max_bytes &&
+      2 * latency_us_ <= max_latency) {
+    page_size_ = Clamp(2.0 * page_size_);
+  }
+}
+
+void AdaptivePageSize::OnPageConsumed(
+    std::chrono::microseconds processing_time) {
+  std::lock_guard<std::mutex> lk(mu_);
+  processing_us_ =
+      Average(processing_us_, static_cast<double>(processing_time.count()));
+}
+
+int AdaptivePageSize::Clamp(double page_size) const {
+  double max_page_size = static_cast<double>(options_.max_page_size);
+  double min_page_size = static_cast<double>(options_.min_page_size);
+  return static_cast<int>(
+      (std::max)(min_page_size, (std::min)(page_size, max_page_size)));
+}
+
+}  // namespace gax
+}  // namespace google
@@ -0,0 +1,106 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GAPIC_GENERATOR_CPP_GAX_ADAPTIVE_PAGE_SIZE_H_
+#define GAPIC_GENERATOR_CPP_GAX_ADAPTIVE_PAGE_SIZE_H_
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace google {
+namespace gax {
+
+/**
+ * Tuning knobs for AdaptivePageSize.
+ */
+struct AdaptivePageSizeOptions {
+  /// The page size of the first request.
+  int initial_page_size = 100;
+  /// Never request pages smaller than this.
+  int min_page_size = 1;
+  /// The largest page size the server accepts.
+  int max_page_size = 1000;
+  /// Shrink the page size when a page's serialized size exceeds this.
+  std::size_t max_page_bytes = 4 * 1024 * 1024;
+  /// Shrink the page size when fetching a page takes longer than this.
+  std::chrono::microseconds max_page_latency = std::chrono::seconds(1);
+};
+
+/**
+ * Chooses the `page_size` of paginated requests from how previous pages
+ * behaved.
+ *
+ * Small pages spend most of their time on per-rpc overhead, large pages hold
+ * more memory and have longer tail latencies. The controller doubles the page
+ * size while fetching pages is the bottleneck, that is, while pages arrive
+ * slower than the caller consumes them, and doubling keeps the page within
+ * both the latency and the size limits. It shrinks the page size in
+ * proportion to the overshoot as soon as a page exceeds either limit. Page
+ * sizes always stay within `[min_page_size, max_page_size]`.
+ *
+ * Pages feeds the controller when it is set in `PagesOptions`; the
+ * NextPageRetriever reads the page size for each request from it.
+ *
+ * All member functions are safe to call concurrently.
+ *
+ * @par Example
+ * @code
+ * auto page_size = std::make_shared<gax::AdaptivePageSize>();
+ * auto get_next_page = [request, stub, page_size](
+ *                          ListElementsResponse* response) mutable {
+ *   request.set_page_size(page_size->PageSize());
+ *   ...
+ * };
+ * gax::PagesOptions options;
+ * options.page_size_controller = page_size;
+ * @endcode
+ */
+class AdaptivePageSize {
+ public:
+  explicit AdaptivePageSize(
+      AdaptivePageSizeOptions options = AdaptivePageSizeOptions());
+
+  AdaptivePageSize(AdaptivePageSize const&) = delete;
+  AdaptivePageSize& operator=(AdaptivePageSize const&) = delete;
+
+  /// The page size to request next.
+  int PageSize() const;
+
+  /**
+   * Record a successfully fetched page and adjust the page size.
+   *
+   * @param latency how long the rpc for the page took.
+   * @param bytes the serialized size of the page.
+   */
+  void OnPageFetched(std::chrono::microseconds latency, std::size_t bytes);
+
+  /// Record how long the caller spent processing a page.
+  void OnPageConsumed(std::chrono::microseconds processing_time);
+
+ private:
+  int Clamp(double page_size) const;
+
+  AdaptivePageSizeOptions const options_;
+  mutable std::mutex mu_;
+  int page_size_;
+  // Exponentially weighted moving averages, negative until the first sample.
+  double latency_us_;
+  double processing_us_;
+};
+
+}  // namespace gax
+}  // namespace google
+
+#endif  // GAPIC_GENERATOR_CPP_GAX_ADAPTIVE_PAGE_SIZE_H_
@@ -0,0 +1,109 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/adaptive_page_size.h"
+#include <gtest/gtest.h>
+#include <chrono>
+
+namespace google {
+namespace gax {
+namespace {
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+AdaptivePageSizeOptions TestOptions() {
+  AdaptivePageSizeOptions options;
+  options.initial_page_size = 10;
+  options.min_page_size = 5;
+  options.max_page_size = 100;
+  options.max_page_bytes = 10000;
+  options.max_page_latency = milliseconds(100);
+  return options;
+}
+
+TEST(AdaptivePageSize, Initial) {
+  EXPECT_EQ(AdaptivePageSize(TestOptions()).PageSize(), 10);
+
+  auto options = TestOptions();
+  options.initial_page_size = 1000;
+  EXPECT_EQ(AdaptivePageSize(options).PageSize(), 100);
+}
+
+TEST(AdaptivePageSize, GrowsWhileFetchBound) {
+  AdaptivePageSize controller(TestOptions());
+  controller.OnPageFetched(milliseconds(10), 1000);
+  EXPECT_EQ(controller.PageSize(), 20);
+  controller.OnPageFetched(milliseconds(10), 2000);
+  EXPECT_EQ(controller.PageSize(), 40);
+  controller.OnPageFetched(milliseconds(10), 4000);
+  EXPECT_EQ(controller.PageSize(), 80);
+  controller.OnPageFetched(milliseconds(10), 4000);
+  EXPECT_EQ(controller.PageSize(), 100);
+}
+
+TEST(AdaptivePageSize, StopsGrowingBeforeLimits) {
+  AdaptivePageSize controller(TestOptions());
+  // Doubling would exceed the byte limit.
+  controller.OnPageFetched(milliseconds(10), 6000);
+  EXPECT_EQ(controller.PageSize(), 10);
+
+  AdaptivePageSize slow(TestOptions());
+  // Doubling would exceed the latency limit.
+  slow.OnPageFetched(milliseconds(60), 1000);
+  EXPECT_EQ(slow.PageSize(), 10);
+}
+
+TEST(AdaptivePageSize, HoldsWhenConsumerIsSlower) {
+  AdaptivePageSize controller(TestOptions());
+  controller.OnPageConsumed(milliseconds(50));
+  controller.OnPageFetched(milliseconds(10), 1000);
+  // Larger pages would not make the caller any faster.
+  EXPECT_EQ(controller.PageSize(), 10);
+
+  controller.OnPageConsumed(microseconds(1));
+  controller.OnPageConsumed(microseconds(1));
+  controller.OnPageConsumed(microseconds(1));
+  controller.OnPageConsumed(microseconds(1));
+  controller.OnPageConsumed(microseconds(1));
+  controller.OnPageConsumed(microseconds(1));
+  controller.OnPageFetched(milliseconds(10), 1000);
+  EXPECT_EQ(controller.PageSize(), 20);
+}
+
+TEST(AdaptivePageSize, ShrinksLargePages) {
+  auto options = TestOptions();
+  options.initial_page_size = 80;
+  AdaptivePageSize controller(options);
+  controller.OnPageFetched(milliseconds(10), 40000);
+  EXPECT_EQ(controller.PageSize(), 20);
+  // Never below the minimum.
+  controller.OnPageFetched(milliseconds(10), 1000000);
+  EXPECT_EQ(controller.PageSize(), 5);
+}
+
+TEST(AdaptivePageSize, ShrinksSlowPages) {
+  auto options = TestOptions();
+  options.initial_page_size = 80;
+  AdaptivePageSize controller(options);
+  controller.OnPageFetched(milliseconds(200), 1000);
+  EXPECT_EQ(controller.PageSize(), 40);
+  // Barely over the limit still shrinks.
+  controller.OnPageFetched(milliseconds(101), 1000);
+  EXPECT_EQ(controller.PageSize(), 39);
+}
+
+}  // namespace
+}  // namespace gax
+}  // namespace google
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "gax/backoff_policy.h"
+#include "gax/internal/random.h"
 #include <algorithm>
 #include <chrono>
 #include <memory>
@@ -22,14 +23,10 @@ namespace google {
 namespace gax {
 
 std::chrono::microseconds ExponentialBackoffPolicy::OnCompletion() {
-  if (!generator_) {
-    generator_ = std::unique_ptr<std::mt19937_64>(
-        new std::mt19937_64(std::random_device()()));
-  }
-
   std::uniform_int_distribution<std::chrono::microseconds::rep> dist(
       current_delay_range_.count() / 2, current_delay_range_.count());
-  auto delay = std::chrono::microseconds(dist(*generator_));
+  auto delay =
+      std::chrono::microseconds(dist(internal::ThreadLocalGenerator()));
 
   current_delay_range_ = std::min(maximum_delay_, current_delay_range_ * 2);
   return delay;
@@ -39,5 +36,34 @@ std::unique_ptr<BackoffPolicy> ExponentialBackoffPolicy::clone() const {
   return std::unique_ptr<BackoffPolicy>(new ExponentialBackoffPolicy(*this));
 }
 
+std::chrono::microseconds FullJitterBackoffPolicy::OnCompletion() {
+  std::uniform_int_distribution<std::chrono::microseconds::rep> dist(
+      0, current_delay_range_.count());
+  auto delay =
+      std::chrono::microseconds(dist(internal::ThreadLocalGenerator()));
+
+  current_delay_range_ = std::min(maximum_delay_, current_delay_range_ * 2);
+  return delay;
+}
+
+std::unique_ptr<BackoffPolicy> FullJitterBackoffPolicy::clone() const {
+  return std::unique_ptr<BackoffPolicy>(new FullJitterBackoffPolicy(*this));
+}
+
+std::chrono::microseconds DecorrelatedJitterBackoffPolicy::OnCompletion() {
+  std::uniform_int_distribution<std::chrono::microseconds::rep> dist(
+      initial_delay_.count(),
+      (std::max)(initial_delay_, previous_delay_ * 3).count());
+  previous_delay_ = (std::min)(
+      maximum_delay_,
+      std::chrono::microseconds(dist(internal::ThreadLocalGenerator())));
+  return previous_delay_;
+}
+
+std::unique_ptr<BackoffPolicy> DecorrelatedJitterBackoffPolicy::clone() const {
+  return std::unique_ptr<BackoffPolicy>(
+      new DecorrelatedJitterBackoffPolicy(*this));
+}
+
 }  // namespace gax
 }  // namespace google
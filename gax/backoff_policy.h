@@ -18,7 +18,6 @@
 #include "gax/internal/gtest_prod.h"
 #include <chrono>
 #include <memory>
-#include <random>
 
 namespace google {
 namespace gax {
@@ -73,8 +72,8 @@ class BackoffPolicy {
  * policy also randomizes the delay each time, to avoid [thundering herd
  * problem](https://en.wikipedia.org/wiki/Thundering_herd_problem).
  *
- * Note: The random number generator used when calculating backoff time in
- *       OnCompletion is lazily created.
+ * Note: The delays are randomized with a small per-thread generator shared by
+ *       all policies, so policies are cheap to copy and clone.
  */
 class ExponentialBackoffPolicy : public BackoffPolicy {
  public:
@@ -125,10 +124,7 @@ class ExponentialBackoffPolicy : public BackoffPolicy {
       : ExponentialBackoffPolicy(rhs.initial_delay_, rhs.maximum_delay_) {}
 
   ExponentialBackoffPolicy(ExponentialBackoffPolicy&& rhs) noexcept
-      : initial_delay_(std::move(rhs.initial_delay_)),
-        current_delay_range_(initial_delay_),
-        maximum_delay_(std::move(rhs.maximum_delay_)),
-        generator_(std::move(rhs.generator_)) {}
+      : ExponentialBackoffPolicy(rhs.initial_delay_, rhs.maximum_delay_) {}
 
   std::chrono::microseconds OnCompletion() override;
 
@@ -139,17 +135,83 @@ class ExponentialBackoffPolicy : public BackoffPolicy {
   FRIEND_TEST(ExponentialBackoffPolicy, CopyConstruct);
   FRIEND_TEST(ExponentialBackoffPolicy, MoveConstruct);
   FRIEND_TEST(ExponentialBackoffPolicy, Clone);
-  FRIEND_TEST(ExponentialBackoffPolicy, LazyGenerator);
 
   std::chrono::microseconds const initial_delay_;
   std::chrono::microseconds current_delay_range_;
   std::chrono::microseconds const maximum_delay_;
+};
+
+/**
+ * Implements a truncated exponential backoff with "full jitter".
+ *
+ * The delay range doubles after each failure, up to @p maximum_delay, like in
+ * ExponentialBackoffPolicy, but each delay is drawn uniformly from the whole
+ * range `[0, range]` rather than its upper half. That spreads the retries of
+ * many clients that failed at the same time over a wider window.
+ *
+ * @see
+ * https://aws.amazon.com/blogs/architecture/exponential-backoff-and-jitter/
+ */
+class FullJitterBackoffPolicy : public BackoffPolicy {
+ public:
+  template <typename duration1_t, typename duration2_t>
+  FullJitterBackoffPolicy(duration1_t initial_delay, duration2_t maximum_delay)
+      : initial_delay_(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                initial_delay)),
+        current_delay_range_(initial_delay_),
+        maximum_delay_(std::chrono::duration_cast<std::chrono::microseconds>(
+            maximum_delay)) {}
+
+  FullJitterBackoffPolicy(FullJitterBackoffPolicy const& rhs) noexcept
+      : FullJitterBackoffPolicy(rhs.initial_delay_, rhs.maximum_delay_) {}
+
+  std::chrono::microseconds OnCompletion() override;
 
-  // Store via pointer and do not initialize until OnCompletion is called.
-  // The 19937 refers to bits of state: as a result, generator_ is very large,
-  // is expensive to create, and in any case most rpcs succeed on the first
-  // call.
-  std::unique_ptr<std::mt19937_64> generator_;
+  std::unique_ptr<BackoffPolicy> clone() const override;
+
+ private:
+  std::chrono::microseconds const initial_delay_;
+  std::chrono::microseconds current_delay_range_;
+  std::chrono::microseconds const maximum_delay_;
+};
+
+/**
+ * Implements a backoff with "decorrelated jitter".
+ *
+ * Each delay is drawn uniformly from `[initial_delay, 3 * previous delay]` and
+ * capped at @p maximum_delay. Delays still grow roughly exponentially, but
+ * every client follows its own random sequence, so retry waves do not stay
+ * synchronized across clients.
+ *
+ * @see
+ * https://aws.amazon.com/blogs/architecture/exponential-backoff-and-jitter/
+ */
+class DecorrelatedJitterBackoffPolicy : public BackoffPolicy {
+ public:
+  template <typename duration1_t, typename duration2_t>
+  DecorrelatedJitterBackoffPolicy(duration1_t initial_delay,
+                                  duration2_t maximum_delay)
+      : initial_delay_(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                initial_delay)),
+        previous_delay_(initial_delay_),
+        maximum_delay_(std::chrono::duration_cast<std::chrono::microseconds>(
+            maximum_delay)) {}
+
+  DecorrelatedJitterBackoffPolicy(
+      DecorrelatedJitterBackoffPolicy const& rhs) noexcept
+      : DecorrelatedJitterBackoffPolicy(rhs.initial_delay_,
+                                        rhs.maximum_delay_) {}
+
+  std::chrono::microseconds OnCompletion() override;
+
+  std::unique_ptr<BackoffPolicy> clone() const override;
+
+ private:
+  std::chrono::microseconds const initial_delay_;
+  std::chrono::microseconds previous_delay_;
+  std::chrono::microseconds const maximum_delay_;
 };
 
 }  // namespace gax
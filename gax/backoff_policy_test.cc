@@ -13,10 +13,14 @@
 // limitations under the License.
 
 #include "gax/backoff_policy.h"
+#include "gax/internal/random.h"
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <memory>
-#include <random>
+#include <set>
+#include <thread>
 
 namespace google {
 namespace gax {
@@ -76,28 +80,75 @@ TEST(ExponentialBackoffPolicy, Clone) {
   EXPECT_EQ(cast_clone->maximum_delay_, std::chrono::milliseconds(320));
 }
 
-TEST(ExponentialBackoffPolicy, LazyGenerator) {
-  ExponentialBackoffPolicy tested(std::chrono::milliseconds(10),
-                                  std::chrono::milliseconds(320));
-  EXPECT_EQ(tested.generator_, nullptr);
-  tested.OnCompletion();
-  EXPECT_NE(tested.generator_, nullptr);
-
-  // Copies and clones use their own lazily constructed generators
-  ExponentialBackoffPolicy copy(tested);
-  EXPECT_EQ(copy.generator_, nullptr);
-  copy.OnCompletion();
-  EXPECT_NE(copy.generator_, nullptr);
-
-  auto clone = std::unique_ptr<ExponentialBackoffPolicy>(
-      static_cast<ExponentialBackoffPolicy*>(copy.clone().release()));
-  EXPECT_EQ(clone->generator_, nullptr);
-  clone->OnCompletion();
-  EXPECT_NE(clone->generator_, nullptr);
-
-  // Moves reuse the existing generator
-  ExponentialBackoffPolicy move(std::move(tested));
-  EXPECT_NE(move.generator_, nullptr);
+TEST(ExponentialBackoffPolicy, Jitter) {
+  // Fresh policies share the thread's generator rather than each seeding an
+  // identical one.
+  std::set<std::chrono::microseconds::rep> delays;
+  for (int i = 0; i < 20; ++i) {
+    ExponentialBackoffPolicy tested(std::chrono::milliseconds(10),
+                                    std::chrono::milliseconds(320));
+    delays.insert(tested.OnCompletion().count());
+  }
+  EXPECT_GT(delays.size(), 1u);
+}
+
+TEST(FullJitterBackoffPolicy, Basic) {
+  FullJitterBackoffPolicy tested(std::chrono::milliseconds(1),
+                                 std::chrono::milliseconds(32));
+  for (int i = 0; i < 8; ++i) {
+    auto range = std::chrono::milliseconds(1 << (std::min)(i, 5));
+    auto delay = tested.OnCompletion();
+    EXPECT_GE(delay, std::chrono::microseconds(0));
+    EXPECT_LE(delay, range);
+  }
+
+  auto clone = tested.clone();
+  EXPECT_LE(clone->OnCompletion(), std::chrono::milliseconds(1));
+}
+
+TEST(DecorrelatedJitterBackoffPolicy, Basic) {
+  DecorrelatedJitterBackoffPolicy tested(std::chrono::milliseconds(1),
+                                         std::chrono::milliseconds(50));
+  std::chrono::microseconds previous = std::chrono::milliseconds(1);
+  for (int i = 0; i < 20; ++i) {
+    auto delay = tested.OnCompletion();
+    EXPECT_GE(delay, std::chrono::milliseconds(1));
+    EXPECT_LE(delay, (std::min)(previous * 3,
+                                std::chrono::microseconds(
+                                    std::chrono::milliseconds(50))));
+    previous = delay;
+  }
+
+  auto clone = tested.clone();
+  EXPECT_LE(clone->OnCompletion(), std::chrono::milliseconds(3));
+}
+
+TEST(ThreadLocalGenerator, Basic) {
+  auto& generator = internal::ThreadLocalGenerator();
+  EXPECT_EQ(&generator, &internal::ThreadLocalGenerator());
+  EXPECT_NE(generator(), generator());
+
+  // Each thread gets its own generator, with its own sequence.
+  internal::Xoshiro256pp* other = nullptr;
+  std::uint64_t other_value = 0;
+  std::thread t([&other, &other_value] {
+    other = &internal::ThreadLocalGenerator();
+    other_value = (*other)();
+  });
+  t.join();
+  EXPECT_NE(other, &generator);
+  EXPECT_NE(other_value, generator());
+}
+
+TEST(Xoshiro256pp, Deterministic) {
+  internal::Xoshiro256pp a(42);
+  internal::Xoshiro256pp b(42);
+  internal::Xoshiro256pp c(43);
+  for (int i = 0; i < 10; ++i) {
+    auto value = a();
+    EXPECT_EQ(value, b());
+    EXPECT_NE(value, c());
+  }
 }
 
 }  // namespace gax
@@ -13,24 +13,60 @@
 // limitations under the License.
 
 #include "gax/call_context.h"
+#include "grpcpp/grpcpp.h"
+#include "gax/routing_header.h"
 #include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
 
 namespace google {
 namespace gax {
 
+std::string ApiClientHeader() {
+  return "gl-cpp/" + std::to_string(__cplusplus) + " grpc/" + grpc::Version();
+}
+
+std::shared_ptr<StaticMetadata const> DefaultStaticMetadata() {
+  static auto const* const kMetadata =
+      new std::shared_ptr<StaticMetadata const>(
+          std::make_shared<StaticMetadata const>(StaticMetadata{
+              {"x-goog-api-client", ApiClientHeader()}}));
+  return *kMetadata;
+}
+
 void CallContext::SetDeadline(std::chrono::system_clock::time_point deadline) {
   deadline_ = std::move(deadline);
 }
 
+CallContext::SharedState& CallContext::MutableState() {
+  if (!state_) {
+    state_ = std::make_shared<SharedState>();
+  } else if (state_.use_count() > 1) {
+    state_ = std::make_shared<SharedState>(*state_);
+  }
+  return *state_;
+}
+
 void CallContext::AddGrpcContextPolicy(GrpcContextPolicyFunc f) {
   context_policies_.emplace_back(std::move(f));
 }
 
 void CallContext::PrepareGrpcContext(grpc::ClientContext* context) {
   context->set_deadline(deadline_);
-
-  for (auto const& m : metadata_) {
-    context->AddMetadata(m.first, m.second);
+  if (static_metadata_) {
+    for (auto const& m : *static_metadata_) {
+      context->AddMetadata(m.first, m.second);
+    }
+  }
+  if (routing_header_) {
+    context->AddMetadata(kRoutingHeaderKey, *routing_header_);
+  }
+  if (state_) {
+    for (auto const& m : state_->metadata) {
+      context->AddMetadata(m.first, m.second);
+    }
   }
 
   for (auto const& f : context_policies_) {
@@ -38,31 +74,85 @@ void CallContext::PrepareGrpcContext(grpc::ClientContext* context) {
   }
 }
 
+gax::CancellationToken::Registration CallContext::BindCancellation(
+    grpc::ClientContext* context) const {
+  if (!cancellation_token_) {
+    return gax::CancellationToken::Registration();
+  }
+  return cancellation_token_->OnCancel([context] { context->TryCancel(); });
+}
+
+void CallContext::SetStaticMetadata(
+    std::shared_ptr<gax::StaticMetadata const> metadata) {
+  static_metadata_ = std::move(metadata);
+}
+
+std::shared_ptr<gax::StaticMetadata const> const&
+CallContext::StaticMetadata() const {
+  return static_metadata_;
+}
+
 void CallContext::AddMetadata(std::string key, std::string val) {
-  metadata_.emplace(std::move(key), std::move(val));
+  MutableState().metadata.emplace(std::move(key), std::move(val));
 }
 
 std::multimap<std::string, std::string const> const& CallContext::Metadata()
     const {
-  return metadata_;
+  static auto const* const kEmpty =
+      new std::multimap<std::string, std::string const>;
+  return state_ ? state_->metadata : *kEmpty;
+}
+
+void CallContext::SetRoutingHeader(std::shared_ptr<std::string const> header) {
+  routing_header_ = std::move(header);
+}
+
+std::shared_ptr<std::string const> const& CallContext::RoutingHeader() const {
+  return routing_header_;
 }
 
 MethodInfo CallContext::Info() const { return method_info_; }
 
 std::unique_ptr<gax::RetryPolicy> CallContext::RetryPolicy() const {
-  return retry_policy_ ? retry_policy_->clone() : nullptr;
+  return state_ && state_->retry_policy ? state_->retry_policy->clone()
+                                        : nullptr;
 }
 
 std::unique_ptr<gax::BackoffPolicy> CallContext::BackoffPolicy() const {
-  return backoff_policy_ ? backoff_policy_->clone() : nullptr;
+  return state_ && state_->backoff_policy ? state_->backoff_policy->clone()
+                                          : nullptr;
+}
+
+std::unique_ptr<gax::HedgingPolicy> CallContext::HedgingPolicy() const {
+  return state_ && state_->hedging_policy ? state_->hedging_policy->clone()
+                                          : nullptr;
+}
+
+bool CallContext::HasPolicyOverrides() const {
+  return state_ && (state_->retry_policy || state_->backoff_policy ||
+                    state_->hedging_policy);
 }
 
 void CallContext::SetRetryPolicy(gax::RetryPolicy const& retry_policy) {
-  retry_policy_ = retry_policy.clone();
+  MutableState().retry_policy = retry_policy.clone();
 }
 
 void CallContext::SetBackoffPolicy(gax::BackoffPolicy const& backoff_policy) {
-  backoff_policy_ = backoff_policy.clone();
+  MutableState().backoff_policy = backoff_policy.clone();
+}
+
+void CallContext::SetHedgingPolicy(gax::HedgingPolicy const& hedging_policy) {
+  MutableState().hedging_policy = hedging_policy.clone();
+}
+
+void CallContext::SetCancellationToken(
+    std::shared_ptr<gax::CancellationToken> token) {
+  cancellation_token_ = std::move(token);
+}
+
+std::shared_ptr<gax::CancellationToken> const& CallContext::CancellationToken()
+    const {
+  return cancellation_token_;
 }
 
 std::chrono::system_clock::time_point CallContext::Deadline() const {
@@ -17,6 +17,9 @@
 
 #include "grpcpp/client_context.h"
 #include "gax/backoff_policy.h"
+#include "gax/cancellation_token.h"
+#include "gax/hedging_policy.h"
+#include "gax/internal/small_vector.h"
 #include "gax/retry_policy.h"
 #include <chrono>
 #include <functional>
@@ -24,6 +27,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 /**
  * Callback type for custom manipulation of grpc::ClientContext.
@@ -34,6 +38,26 @@ using GrpcContextPolicyFunc = std::function<void(grpc::ClientContext*)>;
 namespace google {
 namespace gax {
 
+/**
+ * Metadata that is the same for every call made by a client, such as the
+ * x-goog-api-client header.
+ *
+ * A client builds its block once and shares it by pointer with the
+ * CallContext of each call, so constant headers are never copied per call.
+ */
+using StaticMetadata = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * The value of the x-goog-api-client header sent by generated clients.
+ */
+std::string ApiClientHeader();
+
+/**
+ * The static metadata block used by generated clients, built on first use and
+ * shared by all of them.
+ */
+std::shared_ptr<StaticMetadata const> DefaultStaticMetadata();
+
 /**
  * Compile time information about specific rpc methods.
  * This information can be used by user provided GAPIC stub decorator methods to
@@ -118,26 +142,21 @@ class CallContext {
       : deadline_(std::chrono::system_clock::time_point::max()),
         method_info_(std::move(method_info)) {}
 
-  CallContext(CallContext const& rhs)
-      : deadline_(rhs.deadline_),
-        retry_policy_(rhs.retry_policy_ ? rhs.retry_policy_->clone() : nullptr),
-        backoff_policy_(rhs.backoff_policy_ ? rhs.backoff_policy_->clone()
-                                            : nullptr),
-        context_policies_(rhs.context_policies_),
-        metadata_(rhs.metadata_),
-        method_info_(rhs.method_info_) {}
-
-  CallContext(CallContext&& rhs)
-      : deadline_(rhs.deadline_),
-        retry_policy_(std::move(rhs.retry_policy_)),
-        backoff_policy_(std::move(rhs.backoff_policy_)),
-        context_policies_(std::move(rhs.context_policies_)),
-        metadata_(std::move(rhs.metadata_)),
-        method_info_(std::move(rhs.method_info_)) {}
+  /**
+   * Copies share the policies and metadata of @p rhs until either side
+   * changes them, so copying does not allocate.
+   */
+  CallContext(CallContext const& rhs) = default;
+  CallContext(CallContext&& rhs) = default;
 
   /**
    * Register an arbitrary customization function on grpc::ClientContext.
    * This function could tweak advanced knobs or provide other custom behavior.
+   *
+   * The first few functions are stored inline in the context. Together with
+   * the small-object storage of std::function, this means registering a
+   * lambda that captures a pointer or two, or copying a context holding such
+   * lambdas, does not allocate.
    */
   void AddGrpcContextPolicy(GrpcContextPolicyFunc f);
 
@@ -152,6 +171,25 @@ class CallContext {
    */
   void PrepareGrpcContext(grpc::ClientContext* context);
 
+  /**
+   * Cancel @p context if the attached cancellation token, if any, is
+   * cancelled while the returned registration is alive.
+   *
+   * @par Pre-conditions
+   * The returned registration is destroyed before @p context.
+   */
+  gax::CancellationToken::Registration BindCancellation(
+      grpc::ClientContext* context) const;
+
+  /**
+   * @brief Attach a block of metadata shared by every call of a client.
+   *
+   * The block is shared, not copied, and is added to the grpc::ClientContext
+   * before the metadata registered with AddMetadata().
+   */
+  void SetStaticMetadata(std::shared_ptr<gax::StaticMetadata const> metadata);
+  std::shared_ptr<gax::StaticMetadata const> const& StaticMetadata() const;
+
   /**
    * @brief Register application-specific metadata.
    *
@@ -162,6 +200,16 @@ class CallContext {
 
   std::multimap<std::string, std::string const> const& Metadata() const;
 
+  /**
+   * @brief Set the routing header (`x-goog-request-params`) of the rpc.
+   *
+   * The header is kept apart from the AddMetadata() entries and shared, not
+   * copied, by copies of the context, so setting it does not allocate. Build
+   * it with RoutingHeaderBuffer() and AppendRoutingParam().
+   */
+  void SetRoutingHeader(std::shared_ptr<std::string const> header);
+  std::shared_ptr<std::string const> const& RoutingHeader() const;
+
   /**
    * @brief Set a deadline for the rpc.
    */
@@ -182,12 +230,48 @@ class CallContext {
   void SetBackoffPolicy(gax::BackoffPolicy const& backoff_policy);
   std::unique_ptr<gax::BackoffPolicy> BackoffPolicy() const;
 
+  /**
+   * @brief Enable hedging for the rpc.
+   *
+   * Only honored for idempotent methods. Hedging is disabled by default.
+   */
+  void SetHedgingPolicy(gax::HedgingPolicy const& hedging_policy);
+  std::unique_ptr<gax::HedgingPolicy> HedgingPolicy() const;
+
+  /**
+   * @brief Return true if a retry, backoff, or hedging policy has been set.
+   */
+  bool HasPolicyOverrides() const;
+
+  /**
+   * @brief Attach a token that lets the caller cancel the rpc.
+   *
+   * Unlike policies the token is shared, not cloned, by copies of the context,
+   * so cancelling it affects every attempt of the rpc.
+   */
+  void SetCancellationToken(std::shared_ptr<gax::CancellationToken> token);
+  std::shared_ptr<gax::CancellationToken> const& CancellationToken() const;
+
  private:
+  // The state that stub layers customize once per call. It is immutable while
+  // shared, and copied by the first context that changes it.
+  struct SharedState {
+    std::shared_ptr<gax::RetryPolicy const> retry_policy;
+    std::shared_ptr<gax::BackoffPolicy const> backoff_policy;
+    std::shared_ptr<gax::HedgingPolicy const> hedging_policy;
+    std::multimap<std::string, std::string const> metadata;
+  };
+
+  SharedState& MutableState();
+
   std::chrono::system_clock::time_point deadline_;
-  std::unique_ptr<gax::RetryPolicy const> retry_policy_;
-  std::unique_ptr<gax::BackoffPolicy const> backoff_policy_;
-  std::vector<GrpcContextPolicyFunc> context_policies_;
-  std::multimap<std::string, std::string const> metadata_;
+  std::shared_ptr<SharedState> state_;
+  std::shared_ptr<gax::StaticMetadata const> static_metadata_;
+  std::shared_ptr<std::string const> routing_header_;
+  // Attempts commonly add a policy of their own, so these are kept inline
+  // rather than in the shared state.
+  internal::SmallVector<GrpcContextPolicyFunc, 4> context_policies_;
+  std::shared_ptr<gax::CancellationToken> cancellation_token_;
   MethodInfo const method_info_;
 };
 
@@ -15,9 +15,13 @@
 #include "gax/call_context.h"
 #include "grpcpp/client_context.h"
 #include "gax/backoff_policy.h"
+#include "gax/cancellation_token.h"
+#include "gax/hedging_policy.h"
 #include "gax/retry_policy.h"
+#include "gax/routing_header.h"
 #include <gtest/gtest.h>
 #include <chrono>
+#include <memory>
 #include <set>
 #include <string>
 #include <type_traits>
@@ -79,23 +83,115 @@ TEST(CallContext, CopyAndMove) {
                      MethodInfo::Idempotency::IDEMPOTENT};
   gax::CallContext base(mi);
 
+  EXPECT_FALSE(base.HasPolicyOverrides());
   gax::CallContext no_policy_copy(base);
   EXPECT_FALSE(no_policy_copy.RetryPolicy());
   EXPECT_FALSE(no_policy_copy.BackoffPolicy());
+  EXPECT_FALSE(no_policy_copy.HedgingPolicy());
   gax::CallContext no_policy_move(std::move(no_policy_copy));
   EXPECT_FALSE(no_policy_move.RetryPolicy());
   EXPECT_FALSE(no_policy_move.BackoffPolicy());
+  EXPECT_FALSE(no_policy_move.HedgingPolicy());
 
   base.SetRetryPolicy(
       gax::LimitedErrorCountRetryPolicy<>(10, std::chrono::milliseconds(2)));
   base.SetBackoffPolicy(gax::ExponentialBackoffPolicy(
       std::chrono::milliseconds(1), std::chrono::milliseconds(10)));
+  base.SetHedgingPolicy(
+      gax::FixedDelayHedgingPolicy(1, std::chrono::milliseconds(10)));
+  EXPECT_TRUE(base.HasPolicyOverrides());
   gax::CallContext policy_copy(base);
   EXPECT_TRUE(policy_copy.RetryPolicy());
   EXPECT_TRUE(policy_copy.BackoffPolicy());
+  EXPECT_TRUE(policy_copy.HedgingPolicy());
   gax::CallContext policy_move(std::move(base));
   EXPECT_TRUE(policy_move.RetryPolicy());
   EXPECT_TRUE(policy_move.BackoffPolicy());
+  EXPECT_TRUE(policy_move.HedgingPolicy());
+}
+
+TEST(CallContext, CopyOnWrite) {
+  gax::MethodInfo mi{"TestMethod", MethodInfo::RpcType::NORMAL_RPC,
+                     MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext base(mi);
+  base.AddMetadata("base", "value");
+
+  gax::CallContext copy(base);
+  copy.AddMetadata("copy", "value");
+  copy.SetRetryPolicy(
+      gax::LimitedErrorCountRetryPolicy<>(10, std::chrono::milliseconds(2)));
+  EXPECT_EQ(base.Metadata().size(), 1u);
+  EXPECT_FALSE(base.RetryPolicy());
+  EXPECT_EQ(copy.Metadata().size(), 2u);
+  EXPECT_TRUE(copy.RetryPolicy());
+
+  base.AddMetadata("base2", "value");
+  EXPECT_EQ(base.Metadata().size(), 2u);
+  EXPECT_EQ(copy.Metadata().count("base2"), 0u);
+}
+
+TEST(CallContext, RoutingHeader) {
+  gax::MethodInfo mi{"TestMethod", MethodInfo::RpcType::NORMAL_RPC,
+                     MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext base(mi);
+  EXPECT_FALSE(base.RoutingHeader());
+
+  auto header = gax::RoutingHeaderBuffer();
+  gax::AppendRoutingParam(header.get(), "name", "shelves/1");
+  std::string const* storage = header.get();
+  base.SetRoutingHeader(std::move(header));
+
+  // The header is not part of the metadata and is shared by copies.
+  gax::CallContext copy(base);
+  EXPECT_TRUE(base.Metadata().empty());
+  ASSERT_TRUE(copy.RoutingHeader());
+  EXPECT_EQ(copy.RoutingHeader().get(), storage);
+  EXPECT_EQ(*copy.RoutingHeader(), "name=shelves%2F1");
+}
+
+TEST(CallContext, StaticMetadata) {
+  gax::MethodInfo mi{"TestMethod", MethodInfo::RpcType::NORMAL_RPC,
+                     MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext base(mi);
+  EXPECT_FALSE(base.StaticMetadata());
+
+  auto metadata = gax::DefaultStaticMetadata();
+  ASSERT_EQ(metadata->size(), 1u);
+  EXPECT_EQ(metadata->front().first, "x-goog-api-client");
+  EXPECT_EQ(metadata->front().second, gax::ApiClientHeader());
+  EXPECT_EQ(metadata->front().second.find("gl-cpp/"), 0u);
+  // Every client shares the same block.
+  EXPECT_EQ(metadata, gax::DefaultStaticMetadata());
+
+  base.SetStaticMetadata(metadata);
+  base.AddMetadata("overlay", "value");
+  gax::CallContext copy(base);
+  EXPECT_EQ(copy.StaticMetadata(), metadata);
+  // The static block is not part of the per-call overlay.
+  EXPECT_EQ(copy.Metadata().size(), 1u);
+
+  grpc::ClientContext client_ctx;
+  copy.PrepareGrpcContext(&client_ctx);
+}
+
+TEST(CallContext, CancellationToken) {
+  gax::MethodInfo mi{"TestMethod", MethodInfo::RpcType::NORMAL_RPC,
+                     MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext base(mi);
+  EXPECT_FALSE(base.CancellationToken());
+  grpc::ClientContext unbound;
+  base.BindCancellation(&unbound);
+
+  auto token = std::make_shared<gax::CancellationToken>();
+  base.SetCancellationToken(token);
+  // Copies share the token rather than cloning it.
+  gax::CallContext copy(base);
+  EXPECT_EQ(copy.CancellationToken(), token);
+
+  grpc::ClientContext bound;
+  auto registration = copy.BindCancellation(&bound);
+  token->Cancel();
+  EXPECT_TRUE(base.CancellationToken()->IsCancelled());
 }
 
 }  // namespace gax
@@ -0,0 +1,75 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/cancellation_token.h"
+#include <utility>
+
+namespace google {
+namespace gax {
+
+CancellationToken::Registration& CancellationToken::Registration::operator=(
+    Registration&& rhs) noexcept {
+  if (token_) {
+    token_->Unregister(id_);
+  }
+  token_ = std::move(rhs.token_);
+  id_ = rhs.id_;
+  return *this;
+}
+
+CancellationToken::Registration::~Registration() {
+  if (token_) {
+    token_->Unregister(id_);
+  }
+}
+
+void CancellationToken::Cancel() {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (cancelled_) {
+    return;
+  }
+  cancelled_ = true;
+  // Callbacks run under the lock so that a Registration being destroyed
+  // concurrently waits for its callback to finish.
+  for (auto const& kv : callbacks_) {
+    kv.second();
+  }
+  callbacks_.clear();
+  cv_.notify_all();
+}
+
+bool CancellationToken::IsCancelled() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return cancelled_;
+}
+
+CancellationToken::Registration CancellationToken::OnCancel(
+    std::function<void()> callback) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (cancelled_) {
+    callback();
+    return Registration();
+  }
+  auto id = next_id_++;
+  callbacks_.emplace(id, std::move(callback));
+  return Registration(shared_from_this(), id);
+}
+
+void CancellationToken::Unregister(std::uint64_t id) {
+  std::lock_guard<std::mutex> lk(mu_);
+  callbacks_.erase(id);
+}
+
+}  // namespace gax
+}  // namespace google
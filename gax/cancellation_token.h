@@ -0,0 +1,121 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GAPIC_GENERATOR_CPP_GAX_CANCELLATION_TOKEN_H_
+#define GAPIC_GENERATOR_CPP_GAX_CANCELLATION_TOKEN_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace google {
+namespace gax {
+
+/**
+ * Lets a caller abandon a call that is in progress.
+ *
+ * The caller creates a token, attaches it to the CallContext of one or more
+ * calls, and may later call Cancel() from any thread. Cancelling a token
+ * cancels the in-flight rpc of every call it is attached to and interrupts
+ * their backoff waits; the calls then complete with kCancelled.
+ *
+ * Tokens must be owned by a std::shared_ptr.
+ *
+ * @par Example
+ * @code
+ * auto token = std::make_shared<gax::CancellationToken>();
+ * context.SetCancellationToken(token);
+ * std::thread t([&] { stub->GetFoo(context, request, &response); });
+ * token->Cancel();  // GetFoo() returns promptly.
+ * t.join();
+ * @endcode
+ */
+class CancellationToken
+    : public std::enable_shared_from_this<CancellationToken> {
+ public:
+  /**
+   * Keeps a cancellation callback registered while it is alive.
+   *
+   * Once the destructor returns the callback is not running and will never
+   * run, so it may safely reference objects that are destroyed right after.
+   */
+  class Registration {
+   public:
+    Registration() : id_(0) {}
+    Registration(Registration&& rhs) noexcept
+        : token_(std::move(rhs.token_)), id_(rhs.id_) {}
+    Registration& operator=(Registration&& rhs) noexcept;
+    ~Registration();
+
+   private:
+    friend class CancellationToken;
+    Registration(std::shared_ptr<CancellationToken> token, std::uint64_t id)
+        : token_(std::move(token)), id_(id) {}
+
+    std::shared_ptr<CancellationToken> token_;
+    std::uint64_t id_;
+  };
+
+  CancellationToken() : cancelled_(false), next_id_(1) {}
+
+  CancellationToken(CancellationToken const&) = delete;
+  CancellationToken& operator=(CancellationToken const&) = delete;
+
+  /**
+   * Cancel the token, running every registered callback.
+   *
+   * Only the first call has any effect.
+   */
+  void Cancel();
+
+  bool IsCancelled() const;
+
+  /**
+   * Register @p callback to run when the token is cancelled.
+   *
+   * If the token has already been cancelled, @p callback runs immediately.
+   * Callbacks run with an internal lock held, so they must be short and must
+   * not use the token.
+   */
+  Registration OnCancel(std::function<void()> callback);
+
+  /**
+   * Block the calling thread for @p timeout, or until the token is cancelled.
+   *
+   * @return false if the token was cancelled.
+   */
+  template <typename Rep, typename Period>
+  bool WaitFor(std::chrono::duration<Rep, Period> timeout) {
+    std::unique_lock<std::mutex> lk(mu_);
+    return !cv_.wait_for(lk, timeout, [this] { return cancelled_; });
+  }
+
+ private:
+  void Unregister(std::uint64_t id);
+
+  mutable std::mutex mu_;
+  std::condition_variable cv_;
+  bool cancelled_;
+  std::uint64_t next_id_;
+  std::map<std::uint64_t, std::function<void()>> callbacks_;
+};
+
+}  // namespace gax
+}  // namespace google
+
+#endif  // GAPIC_GENERATOR_CPP_GAX_CANCELLATION_TOKEN_H_
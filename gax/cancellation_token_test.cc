@@ -0,0 +1,76 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/cancellation_token.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace google {
+namespace gax {
+
+TEST(CancellationToken, Callbacks) {
+  auto token = std::make_shared<CancellationToken>();
+  int first = 0;
+  int second = 0;
+  auto first_registration = token->OnCancel([&first] { first++; });
+  {
+    auto second_registration = token->OnCancel([&second] { second++; });
+  }
+  EXPECT_FALSE(token->IsCancelled());
+
+  token->Cancel();
+  token->Cancel();
+  EXPECT_TRUE(token->IsCancelled());
+  EXPECT_EQ(first, 1);
+  // Unregistered before the token was cancelled.
+  EXPECT_EQ(second, 0);
+
+  // Registering on a cancelled token runs the callback right away.
+  int late = 0;
+  auto late_registration = token->OnCancel([&late] { late++; });
+  EXPECT_EQ(late, 1);
+}
+
+TEST(CancellationToken, RegistrationMove) {
+  auto token = std::make_shared<CancellationToken>();
+  int count = 0;
+  CancellationToken::Registration outer;
+  {
+    auto inner = token->OnCancel([&count] { count++; });
+    outer = std::move(inner);
+  }
+  token->Cancel();
+  EXPECT_EQ(count, 1);
+}
+
+TEST(CancellationToken, WaitFor) {
+  auto token = std::make_shared<CancellationToken>();
+  EXPECT_TRUE(token->WaitFor(std::chrono::milliseconds(1)));
+
+  std::thread canceller([token] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    token->Cancel();
+  });
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(token->WaitFor(std::chrono::hours(1)));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::minutes(1));
+  canceller.join();
+
+  EXPECT_FALSE(token->WaitFor(std::chrono::hours(1)));
+}
+
+}  // namespace gax
+}  // namespace google
@@ -0,0 +1,219 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GAPIC_GENERATOR_CPP_GAX_CIRCUIT_BREAKER_H_
+#define GAPIC_GENERATOR_CPP_GAX_CIRCUIT_BREAKER_H_
+
+#include "gax/retry_policy.h"
+#include "gax/status.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace google {
+namespace gax {
+
+/**
+ * Tuning knobs for a CircuitBreaker.
+ */
+struct CircuitBreakerOptions {
+  /// Open the circuit once this fraction of calls in a window fail.
+  double failure_rate_threshold = 0.5;
+  /// Never open the circuit on a window with fewer calls than this.
+  int minimum_calls = 20;
+  /// The length of the window over which the failure rate is measured.
+  std::chrono::milliseconds window = std::chrono::seconds(10);
+  /// How long the circuit stays open before probe calls are let through.
+  std::chrono::milliseconds open_duration = std::chrono::seconds(5);
+  /// The number of successful probes needed to close the circuit again. This
+  /// is also the maximum number of concurrent probes.
+  int probe_calls = 1;
+};
+
+enum class CircuitBreakerState { kClosed = 0, kOpen, kHalfOpen };
+
+/**
+ * The decision made by CircuitBreaker::Allow(), to be handed back with the
+ * call's outcome.
+ */
+enum class CircuitBreakerAdmission { kRejected = 0, kAdmitted, kProbe };
+
+/**
+ * Fail calls fast while a backend is persistently unavailable.
+ *
+ * While closed, the breaker counts calls and transient failures over a fixed
+ * window. Once the failure rate of a window with enough calls reaches the
+ * threshold the breaker opens, and calls are rejected without being sent. After
+ * `open_duration` the breaker becomes half-open and admits a limited number of
+ * probe calls: if enough of them succeed it closes, and any transient failure
+ * opens it again.
+ *
+ * Permanent failures (e.g. kNotFound) mean the backend is answering, so they
+ * count as successes for the purpose of the breaker.
+ *
+ * All member functions are lock-free and safe to call concurrently. Under
+ * contention the window counters are approximate; this only shifts the exact
+ * moment the breaker trips.
+ *
+ * @par Example
+ * @code
+ * auto admission = breaker.Allow();
+ * if (admission == gax::CircuitBreakerAdmission::kRejected) {
+ *   return gax::Status(gax::StatusCode::kUnavailable, "circuit open");
+ * }
+ * gax::Status status = stub->GetFoo(context, request, response);
+ * breaker.OnResult(admission, status);
+ * @endcode
+ */
+template <typename Clock = DefaultClock>
+class CircuitBreaker {
+ public:
+  explicit CircuitBreaker(CircuitBreakerOptions options, Clock c = Clock{})
+      : options_(std::move(options)),
+        c_(std::move(c)),
+        state_(static_cast<int>(CircuitBreakerState::kClosed)),
+        window_start_(Now()),
+        calls_(0),
+        failures_(0),
+        opened_at_(0),
+        probes_in_flight_(0),
+        probe_successes_(0) {}
+
+  CircuitBreaker(CircuitBreaker const&) = delete;
+  CircuitBreaker& operator=(CircuitBreaker const&) = delete;
+
+  /**
+   * Decide whether a call may be sent.
+   */
+  CircuitBreakerAdmission Allow() {
+    switch (state()) {
+      case CircuitBreakerState::kClosed:
+        return CircuitBreakerAdmission::kAdmitted;
+      case CircuitBreakerState::kOpen:
+        if (Now() - opened_at_.load(std::memory_order_acquire) <
+            Ticks(options_.open_duration)) {
+          return CircuitBreakerAdmission::kRejected;
+        }
+        if (Transition(CircuitBreakerState::kOpen,
+                       CircuitBreakerState::kHalfOpen)) {
+          probes_in_flight_.store(0, std::memory_order_relaxed);
+          probe_successes_.store(0, std::memory_order_relaxed);
+        }
+        return TryProbe();
+      case CircuitBreakerState::kHalfOpen:
+        return TryProbe();
+    }
+    return CircuitBreakerAdmission::kRejected;
+  }
+
+  /**
+   * Record the outcome of a call admitted by Allow().
+   */
+  void OnResult(CircuitBreakerAdmission admission, Status const& status) {
+    bool failed = status.IsTransientFailure();
+    if (admission == CircuitBreakerAdmission::kProbe) {
+      probes_in_flight_.fetch_sub(1, std::memory_order_relaxed);
+      if (failed) {
+        Open(CircuitBreakerState::kHalfOpen);
+      } else if (probe_successes_.fetch_add(1, std::memory_order_relaxed) +
+                     1 >=
+                 options_.probe_calls) {
+        ResetWindow(Now());
+        Transition(CircuitBreakerState::kHalfOpen,
+                   CircuitBreakerState::kClosed);
+      }
+      return;
+    }
+    if (admission != CircuitBreakerAdmission::kAdmitted ||
+        state() != CircuitBreakerState::kClosed) {
+      return;
+    }
+
+    auto now = Now();
+    if (now - window_start_.load(std::memory_order_relaxed) >=
+        Ticks(options_.window)) {
+      ResetWindow(now);
+    }
+    int calls = calls_.fetch_add(1, std::memory_order_relaxed) + 1;
+    int failures = failures_.load(std::memory_order_relaxed);
+    if (failed) {
+      failures = failures_.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    if (failed && calls >= options_.minimum_calls &&
+        failures >= options_.failure_rate_threshold * calls) {
+      Open(CircuitBreakerState::kClosed);
+    }
+  }
+
+  CircuitBreakerState state() const {
+    return static_cast<CircuitBreakerState>(
+        state_.load(std::memory_order_acquire));
+  }
+
+ private:
+  std::int64_t Now() const {
+    return c_.now().time_since_epoch().count();
+  }
+
+  template <typename Rep, typename Period>
+  static std::int64_t Ticks(std::chrono::duration<Rep, Period> d) {
+    return std::chrono::duration_cast<
+               typename internal::ClockTimePoint<Clock>::duration>(d)
+        .count();
+  }
+
+  bool Transition(CircuitBreakerState from, CircuitBreakerState to) {
+    int expected = static_cast<int>(from);
+    return state_.compare_exchange_strong(expected, static_cast<int>(to),
+                                          std::memory_order_acq_rel);
+  }
+
+  void Open(CircuitBreakerState from) {
+    // Publish the time before the state, Allow() reads them in reverse.
+    opened_at_.store(Now(), std::memory_order_release);
+    Transition(from, CircuitBreakerState::kOpen);
+  }
+
+  void ResetWindow(std::int64_t now) {
+    window_start_.store(now, std::memory_order_relaxed);
+    calls_.store(0, std::memory_order_relaxed);
+    failures_.store(0, std::memory_order_relaxed);
+  }
+
+  CircuitBreakerAdmission TryProbe() {
+    int in_flight = probes_in_flight_.load(std::memory_order_relaxed);
+    while (in_flight < options_.probe_calls) {
+      if (probes_in_flight_.compare_exchange_weak(
+              in_flight, in_flight + 1, std::memory_order_relaxed)) {
+        return CircuitBreakerAdmission::kProbe;
+      }
+    }
+    return CircuitBreakerAdmission::kRejected;
+  }
+
+  CircuitBreakerOptions const options_;
+  Clock c_;
+  std::atomic<int> state_;
+  std::atomic<std::int64_t> window_start_;
+  std::atomic<int> calls_;
+  std::atomic<int> failures_;
+  std::atomic<std::int64_t> opened_at_;
+  std::atomic<int> probes_in_flight_;
+  std::atomic<int> probe_successes_;
+};
+
+}  // namespace gax
+}  // namespace google
+
+#endif  // GAPIC_GENERATOR_CPP_GAX_CIRCUIT_BREAKER_H_
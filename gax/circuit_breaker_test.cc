@@ -0,0 +1,148 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/circuit_breaker.h"
+#include "gax/internal/test_clock.h"
+#include "gax/status.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace gax {
+
+using internal::TestClock;
+
+CircuitBreakerOptions TestOptions() {
+  CircuitBreakerOptions options;
+  options.failure_rate_threshold = 0.5;
+  options.minimum_calls = 4;
+  options.window = std::chrono::seconds(10);
+  options.open_duration = std::chrono::seconds(1);
+  options.probe_calls = 2;
+  return options;
+}
+
+Status const kUnavailable(StatusCode::kUnavailable, "Unavailable");
+
+void Call(CircuitBreaker<TestClock>& breaker, Status const& status) {
+  auto admission = breaker.Allow();
+  ASSERT_NE(admission, CircuitBreakerAdmission::kRejected);
+  breaker.OnResult(admission, status);
+}
+
+TEST(CircuitBreaker, OpensOnFailureRate) {
+  std::chrono::system_clock::time_point now_point;
+  CircuitBreaker<TestClock> breaker(TestOptions(), TestClock(now_point));
+
+  // Not enough calls yet.
+  Call(breaker, kUnavailable);
+  Call(breaker, kUnavailable);
+  Call(breaker, Status{});
+  EXPECT_EQ(breaker.state(), CircuitBreakerState::kClosed);
+
+  // 3 of 4 calls failed.
+  Call(breaker, kUnavailable);
+  EXPECT_EQ(breaker.state(), CircuitBreakerState::kOpen);
+  EXPECT_EQ(breaker.Allow(), CircuitBreakerAdmission::kRejected);
+}
+
+TEST(CircuitBreaker, PermanentFailuresDoNotCount) {
+  std::chrono::system_clock::time_point now_point;
+  CircuitBreaker<TestClock> breaker(TestOptions(), TestClock(now_point));
+
+  for (int i = 0; i < 10; ++i) {
+    Call(breaker, Status(StatusCode::kNotFound, "NotFound"));
+  }
+  EXPECT_EQ(breaker.state(), CircuitBreakerState::kClosed);
+}
+
+TEST(CircuitBreaker, WindowResets) {
+  std::chrono::system_clock::time_point now_point;
+  CircuitBreaker<TestClock> breaker(TestOptions(), TestClock(now_point));
+
+  for (int i = 0; i < 3; ++i) {
+    Call(breaker, Status{});
+  }
+  Call(breaker, kUnavailable);
+  now_point += std::chrono::seconds(11);
+  // The successes above have aged out, but this window is too small.
+  Call(breaker, kUnavailable);
+  Call(breaker, kUnavailable);
+  EXPECT_EQ(breaker.state(), CircuitBreakerState::kClosed);
+}
+
+TEST(CircuitBreaker, HalfOpenProbes) {
+  std::chrono::system_clock::time_point now_point;
+  CircuitBreaker<TestClock> breaker(TestOptions(), TestClock(now_point));
+  for (int i = 0; i < 4; ++i) {
+    Call(breaker, kUnavailable);
+  }
+  ASSERT_EQ(breaker.state(), CircuitBreakerState::kOpen);
+
+  now_point += std::chrono::milliseconds(500);
+  EXPECT_EQ(breaker.Allow(), CircuitBreakerAdmission::kRejected);
+
+  // Only probe_calls probes are let through at a time.
+  now_point += std::chrono::milliseconds(500);
+  auto first = breaker.Allow();
+  auto second = breaker.Allow();
+  EXPECT_EQ(first, CircuitBreakerAdmission::kProbe);
+  EXPECT_EQ(second, CircuitBreakerAdmission::kProbe);
+  EXPECT_EQ(breaker.Allow(), CircuitBreakerAdmission::kRejected);
+  EXPECT_EQ(breaker.state(), CircuitBreakerState::kHalfOpen);
+
+  // A failed probe opens the circuit again.
+  breaker.OnResult(first, kUnavailable);
+  EXPECT_EQ(breaker.state(), CircuitBreakerState::kOpen);
+  breaker.OnResult(second, Status{});
+  EXPECT_EQ(breaker.state(), CircuitBreakerState::kOpen);
+  EXPECT_EQ(breaker.Allow(), CircuitBreakerAdmission::kRejected);
+
+  // Enough successful probes close it.
+  now_point += std::chrono::seconds(1);
+  first = breaker.Allow();
+  second = breaker.Allow();
+  breaker.OnResult(first, Status{});
+  EXPECT_EQ(breaker.state(), CircuitBreakerState::kHalfOpen);
+  breaker.OnResult(second, Status{});
+  EXPECT_EQ(breaker.state(), CircuitBreakerState::kClosed);
+  EXPECT_EQ(breaker.Allow(), CircuitBreakerAdmission::kAdmitted);
+}
+
+TEST(CircuitBreaker, Concurrent) {
+  CircuitBreakerOptions options = TestOptions();
+  options.minimum_calls = 1000;
+  CircuitBreaker<> breaker(options);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&breaker] {
+      for (int i = 0; i < 1000; ++i) {
+        auto admission = breaker.Allow();
+        if (admission != CircuitBreakerAdmission::kRejected) {
+          breaker.OnResult(admission, kUnavailable);
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(breaker.state(), CircuitBreakerState::kOpen);
+}
+
+}  // namespace gax
+}  // namespace google
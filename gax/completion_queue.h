@@ -0,0 +1,127 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GAPIC_GENERATOR_CPP_GAX_COMPLETION_QUEUE_H_
+#define GAPIC_GENERATOR_CPP_GAX_COMPLETION_QUEUE_H_
+
+#include "grpcpp/client_context.h"
+#include "grpcpp/completion_queue.h"
+#include "grpcpp/impl/codegen/async_unary_call.h"
+#include "gax/call_context.h"
+#include "gax/cancellation_token.h"
+#include "gax/status.h"
+#include <functional>
+#include <memory>
+#include <utility>
+
+namespace google {
+namespace gax {
+
+/**
+ * An asynchronous operation whose tag has been placed on a
+ * grpc::CompletionQueue.
+ *
+ * All asynchronous gax code uses heap allocated AsyncOperation instances as
+ * completion queue tags. The thread(s) driving the queue hand each event back
+ * to its operation via Notify() and then delete the operation; see
+ * RunCompletionQueue().
+ */
+class AsyncOperation {
+ public:
+  virtual ~AsyncOperation() = default;
+
+  /**
+   * Handle the completion queue event for this operation.
+   *
+   * @param ok the `ok` value reported by grpc::CompletionQueue::Next().
+   */
+  virtual void Notify(bool ok) = 0;
+};
+
+/**
+ * Drive a completion queue whose tags are all AsyncOperations.
+ *
+ * Blocks the calling thread, dispatching events until the queue has been shut
+ * down and fully drained. Any number of threads may run the same queue.
+ */
+void RunCompletionQueue(grpc::CompletionQueue* cq);
+
+/**
+ * A single asynchronous unary rpc.
+ *
+ * Owns the grpc::ClientContext and response reader for the rpc. Generated stubs
+ * create one of these on the heap, call Prepare(), and then call Start(); from
+ * that point on the instance is owned by the completion queue.
+ *
+ * @par Example
+ * @code
+ * auto* rpc = new gax::AsyncUnaryRpc<Foo>(std::move(done));
+ * rpc->Prepare(context);
+ * rpc->Start(grpc_stub_->PrepareAsyncGetFoo(rpc->grpc_context(), request, cq),
+ *            response);
+ * @endcode
+ *
+ * @tparam ResponseT the response message type of the rpc.
+ */
+template <typename ResponseT>
+class AsyncUnaryRpc final : public AsyncOperation {
+ public:
+  explicit AsyncUnaryRpc(std::function<void(gax::Status)> done)
+      : done_(std::move(done)) {}
+
+  grpc::ClientContext* grpc_context() { return &grpc_context_; }
+
+  /**
+   * Initialize grpc_context() from @p context, and cancel the rpc if the
+   * context's cancellation token is cancelled.
+   */
+  void Prepare(gax::CallContext& context) {
+    context.PrepareGrpcContext(&grpc_context_);
+    cancellation_ = context.BindCancellation(&grpc_context_);
+  }
+
+  /**
+   * Start the rpc.
+   *
+   * @param reader the not-yet-started reader for the rpc, as returned by the
+   *     gRPC stub's PrepareAsync* method.
+   * @param response the response message to fill. Must remain valid until the
+   *     completion callback runs.
+   */
+  void Start(
+      std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<ResponseT>>
+          reader,
+      ResponseT* response) {
+    reader_ = std::move(reader);
+    reader_->StartCall();
+    reader_->Finish(response, &status_, this);
+  }
+
+  // Note: Finish() always produces exactly one event with ok == true,
+  // the outcome of the rpc is carried by status_.
+  void Notify(bool) override { done_(gax::GrpcStatusToGaxStatus(status_)); }
+
+ private:
+  std::function<void(gax::Status)> done_;
+  grpc::ClientContext grpc_context_;
+  grpc::Status status_;
+  std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<ResponseT>> reader_;
+  // Must be unregistered before grpc_context_ goes away.
+  gax::CancellationToken::Registration cancellation_;
+};
+
+}  // namespace gax
+}  // namespace google
+
+#endif  // GAPIC_GENERATOR_CPP_GAX_COMPLETION_QUEUE_H_
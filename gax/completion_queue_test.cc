@@ -0,0 +1,66 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/completion_queue.h"
+#include "grpcpp/alarm.h"
+#include "grpcpp/completion_queue.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace google {
+namespace gax {
+namespace {
+
+class RecordingOperation : public AsyncOperation {
+ public:
+  RecordingOperation(std::vector<bool>& notified, int& destroyed)
+      : notified_(notified), destroyed_(destroyed) {}
+  ~RecordingOperation() override { destroyed_++; }
+
+  void Notify(bool ok) override { notified_.push_back(ok); }
+
+  grpc::Alarm alarm;
+
+ private:
+  std::vector<bool>& notified_;
+  int& destroyed_;
+};
+
+TEST(CompletionQueue, RunDispatchesAndDeletes) {
+  grpc::CompletionQueue cq;
+  std::vector<bool> notified;
+  int destroyed = 0;
+
+  auto* fired = new RecordingOperation(notified, destroyed);
+  fired->alarm.Set(&cq, std::chrono::system_clock::now(), fired);
+  auto* cancelled = new RecordingOperation(notified, destroyed);
+  cancelled->alarm.Set(
+      &cq, std::chrono::system_clock::now() + std::chrono::hours(1), cancelled);
+  cancelled->alarm.Cancel();
+
+  // Events that are already pending are still delivered after Shutdown.
+  cq.Shutdown();
+  RunCompletionQueue(&cq);
+
+  EXPECT_EQ(notified.size(), std::size_t(2));
+  EXPECT_EQ(std::count(notified.begin(), notified.end(), true), 1);
+  EXPECT_EQ(std::count(notified.begin(), notified.end(), false), 1);
+  EXPECT_EQ(destroyed, 2);
+}
+
+}  // namespace
+}  // namespace gax
+}  // namespace google
@@ -0,0 +1,330 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GAPIC_GENERATOR_CPP_GAX_HEDGED_CALL_H_
+#define GAPIC_GENERATOR_CPP_GAX_HEDGED_CALL_H_
+
+#include "grpcpp/alarm.h"
+#include "grpcpp/client_context.h"
+#include "grpcpp/completion_queue.h"
+#include "gax/call_context.h"
+#include "gax/completion_queue.h"
+#include "gax/hedging_policy.h"
+#include "gax/internal/invoke_result.h"
+#include "gax/retry_budget.h"
+#include "gax/retry_loop.h"
+#include "gax/retry_policy.h"
+#include "gax/status.h"
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace gax {
+
+namespace internal {
+
+/**
+ * The state of one hedged call.
+ *
+ * Every in-flight attempt and the pending hedge timer, if any, hold a
+ * reference to the call. All mutable state is guarded by mu_, which is never
+ * held while invoking the next stub or the completion callback.
+ */
+template <typename RequestT, typename ResponseT, typename FunctorT>
+class HedgedCall : public std::enable_shared_from_this<
+                       HedgedCall<RequestT, ResponseT, FunctorT>> {
+ public:
+  HedgedCall(gax::CallContext const& context, RequestT const& request,
+             ResponseT* response, grpc::CompletionQueue* cq,
+             FunctorT next_stub, std::unique_ptr<gax::RetryPolicy> retry_policy,
+             std::unique_ptr<gax::HedgingPolicy> hedging_policy,
+             std::function<void(gax::Status)> done,
+             gax::RetryBudget* retry_budget)
+      : context_(context),
+        request_(request),
+        response_(response),
+        cq_(cq),
+        next_stub_(std::move(next_stub)),
+        retry_policy_(std::move(retry_policy)),
+        hedging_policy_(std::move(hedging_policy)),
+        done_(std::move(done)),
+        retry_budget_(retry_budget) {}
+
+  void Start() {
+    std::unique_lock<std::mutex> lk(mu_);
+    StartAttempt(lk);
+  }
+
+ private:
+  struct Attempt {
+    explicit Attempt(gax::CallContext const& c) : context(c) {}
+
+    gax::CallContext context;
+    ResponseT response;
+    // Only set while the rpc is in flight.
+    grpc::ClientContext* grpc_context = nullptr;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  class HedgeTimer final : public gax::AsyncOperation {
+   public:
+    explicit HedgeTimer(std::shared_ptr<HedgedCall> call)
+        : call_(std::move(call)) {}
+
+    void Set(grpc::CompletionQueue* cq, std::chrono::microseconds delay) {
+      alarm_.Set(cq, std::chrono::system_clock::now() + delay, this);
+    }
+
+    void Cancel() { alarm_.Cancel(); }
+
+    void Notify(bool ok) override { call_->OnHedgeTimer(this, ok); }
+
+   private:
+    std::shared_ptr<HedgedCall> call_;
+    grpc::Alarm alarm_;
+  };
+
+  // Start a new attempt and, if the policy allows another one, arm the timer
+  // for it. Releases @p lk.
+  void StartAttempt(std::unique_lock<std::mutex>& lk) {
+    attempts_.emplace_back(new Attempt(context_));
+    Attempt* attempt = attempts_.back().get();
+    ++outstanding_;
+    attempt->context.SetDeadline(AttemptDeadline(context_, *retry_policy_));
+    attempt->start = std::chrono::steady_clock::now();
+    // Remember the grpc::ClientContext so the attempt can be cancelled if
+    // another one wins. The attempt's own callback keeps `this` alive until
+    // the rpc completes, so a raw pointer avoids a reference cycle.
+    HedgedCall* call = this;
+    attempt->context.AddGrpcContextPolicy(
+        [call, attempt](grpc::ClientContext* c) {
+          std::lock_guard<std::mutex> lk(call->mu_);
+          if (call->finished_) {
+            c->TryCancel();
+            return;
+          }
+          attempt->grpc_context = c;
+        });
+
+    if (static_cast<int>(attempts_.size()) <=
+        hedging_policy_->MaxHedgedAttempts()) {
+      // The completion queue owns the timer once it has been set.
+      timer_ = new HedgeTimer(this->shared_from_this());
+      timer_->Set(cq_, hedging_policy_->HedgingDelay());
+    }
+    lk.unlock();
+
+    auto self = this->shared_from_this();
+    next_stub_(attempt->context, request_, &attempt->response, cq_,
+               [self, attempt](gax::Status status) {
+                 self->OnAttempt(attempt, status);
+               });
+  }
+
+  void OnHedgeTimer(HedgeTimer* timer, bool ok) {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (timer_ == timer) {
+      timer_ = nullptr;
+    }
+    if (!ok || finished_) {
+      return;
+    }
+    // Hedges draw from the same budget as retries.
+    if (retry_budget_ && !retry_budget_->TryRetry()) {
+      return;
+    }
+    StartAttempt(lk);
+  }
+
+  void OnAttempt(Attempt* attempt, gax::Status const& status) {
+    std::unique_lock<std::mutex> lk(mu_);
+    attempt->grpc_context = nullptr;
+    --outstanding_;
+    if (finished_) {
+      return;
+    }
+
+    if (status.IsOk()) {
+      if (retry_budget_) {
+        retry_budget_->OnSuccess();
+      }
+      hedging_policy_->OnAttemptLatency(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - attempt->start));
+      *response_ = std::move(attempt->response);
+      Finish(lk, status);
+      return;
+    }
+
+    if (!retry_policy_->OnFailure(status)) {
+      Finish(lk, status);
+      return;
+    }
+
+    // A transient failure: send the next attempt right away rather than
+    // waiting for the timer.
+    if (static_cast<int>(attempts_.size()) <=
+            hedging_policy_->MaxHedgedAttempts() &&
+        (!retry_budget_ || retry_budget_->TryRetry())) {
+      if (timer_) {
+        timer_->Cancel();
+        timer_ = nullptr;
+      }
+      StartAttempt(lk);
+      return;
+    }
+
+    if (outstanding_ == 0) {
+      Finish(lk, status);
+    }
+  }
+
+  // Cancel everything still in flight and report @p status. Releases @p lk.
+  void Finish(std::unique_lock<std::mutex>& lk, gax::Status const& status) {
+    finished_ = true;
+    for (auto const& a : attempts_) {
+      if (a->grpc_context) {
+        a->grpc_context->TryCancel();
+      }
+    }
+    if (timer_) {
+      timer_->Cancel();
+      timer_ = nullptr;
+    }
+    auto done = std::move(done_);
+    lk.unlock();
+    done(status);
+  }
+
+  gax::CallContext const context_;
+  RequestT const& request_;
+  ResponseT* response_;
+  grpc::CompletionQueue* cq_;
+  FunctorT next_stub_;
+
+  std::mutex mu_;
+  std::unique_ptr<gax::RetryPolicy> retry_policy_;
+  std::unique_ptr<gax::HedgingPolicy> hedging_policy_;
+  std::function<void(gax::Status)> done_;
+  gax::RetryBudget* retry_budget_;
+  std::vector<std::unique_ptr<Attempt>> attempts_;
+  int outstanding_ = 0;
+  HedgeTimer* timer_ = nullptr;
+  bool finished_ = false;
+};
+
+}  // namespace internal
+
+/**
+ * Invoke @p next_stub, sending additional attempts while earlier ones are
+ * still outstanding, and report the first success.
+ *
+ * A new attempt is sent whenever the hedging policy's delay elapses without a
+ * result, and immediately whenever an attempt fails with a status the retry
+ * policy considers transient, up to the policy's maximum number of hedged
+ * attempts. Once an attempt succeeds, or fails permanently, the remaining
+ * attempts are cancelled via their grpc::ClientContext and @p done is invoked
+ * exactly once. Each attempt gets the tighter of the deadline set on
+ * @p context and the retry policy's operation deadline.
+ *
+ * Sending the same request several times is only safe for idempotent methods;
+ * callers are responsible for checking MethodInfo::idempotency.
+ *
+ * @par Pre-conditions
+ * @p request and @p response must remain valid until @p done is called.
+ * Cancelled attempts may complete after @p done has been called, so the
+ * next stub must not use the request once it has started an rpc.
+ *
+ * @param next_stub a functor with the signature
+ *     `void(gax::CallContext&, RequestT const&, ResponseT*,
+ *           grpc::CompletionQueue*, std::function<void(gax::Status)>)`
+ *     that starts a single asynchronous attempt.
+ * @param retry_budget if not null, each attempt after the first must be
+ *     admitted by this budget. Not owned, must outlive the call.
+ */
+template <typename RequestT, typename ResponseT, typename FunctorT,
+          typename std::enable_if<
+              gax::internal::is_invocable<
+                  FunctorT, gax::CallContext&, RequestT const&, ResponseT*,
+                  grpc::CompletionQueue*,
+                  std::function<void(gax::Status)>>::value,
+              int>::type = 0>
+void MakeAsyncHedgedCall(gax::CallContext const& context,
+                         RequestT const& request, ResponseT* response,
+                         grpc::CompletionQueue* cq, FunctorT&& next_stub,
+                         std::unique_ptr<gax::RetryPolicy> retry_policy,
+                         std::unique_ptr<gax::HedgingPolicy> hedging_policy,
+                         std::function<void(gax::Status)> done,
+                         gax::RetryBudget* retry_budget = nullptr) {
+  using Call = internal::HedgedCall<RequestT, ResponseT,
+                                    typename std::decay<FunctorT>::type>;
+  std::make_shared<Call>(context, request, response, cq,
+                         std::forward<FunctorT>(next_stub),
+                         std::move(retry_policy), std::move(hedging_policy),
+                         std::move(done), retry_budget)
+      ->Start();
+}
+
+/**
+ * Synchronous counterpart of MakeAsyncHedgedCall.
+ *
+ * The attempts run on a private completion queue driven by the calling thread.
+ * Returns once the winning attempt has completed and every cancelled attempt
+ * has wound down.
+ */
+template <typename RequestT, typename ResponseT, typename FunctorT,
+          typename std::enable_if<
+              gax::internal::is_invocable<
+                  FunctorT, gax::CallContext&, RequestT const&, ResponseT*,
+                  grpc::CompletionQueue*,
+                  std::function<void(gax::Status)>>::value,
+              int>::type = 0>
+gax::Status MakeHedgedCall(gax::CallContext& context, RequestT const& request,
+                           ResponseT* response, FunctorT&& next_stub,
+                           std::unique_ptr<gax::RetryPolicy> retry_policy,
+                           std::unique_ptr<gax::HedgingPolicy> hedging_policy,
+                           gax::RetryBudget* retry_budget = nullptr) {
+  grpc::CompletionQueue cq;
+  std::promise<gax::Status> promise;
+  auto result = promise.get_future();
+  MakeAsyncHedgedCall(context, request, response, &cq,
+                      std::forward<FunctorT>(next_stub),
+                      std::move(retry_policy), std::move(hedging_policy),
+                      [&promise](gax::Status status) {
+                        promise.set_value(std::move(status));
+                      },
+                      retry_budget);
+
+  void* tag;
+  bool ok;
+  while (result.wait_for(std::chrono::seconds(0)) !=
+             std::future_status::ready &&
+         cq.Next(&tag, &ok)) {
+    std::unique_ptr<gax::AsyncOperation> op(
+        static_cast<gax::AsyncOperation*>(tag));
+    op->Notify(ok);
+  }
+  cq.Shutdown();
+  gax::RunCompletionQueue(&cq);
+  return result.get();
+}
+
+}  // namespace gax
+}  // namespace google
+
+#endif  // GAPIC_GENERATOR_CPP_GAX_HEDGED_CALL_H_
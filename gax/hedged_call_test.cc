@@ -0,0 +1,252 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/hedged_call.h"
+#include "google/longrunning/operations.pb.h"
+#include "grpcpp/alarm.h"
+#include "grpcpp/client_context.h"
+#include "gax/call_context.h"
+#include "gax/completion_queue.h"
+#include "gax/hedging_policy.h"
+#include "gax/internal/test_clock.h"
+#include "gax/retry_budget.h"
+#include "gax/retry_policy.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+using namespace ::google;
+
+std::unique_ptr<gax::RetryPolicy> ErrCountRetryFactory(
+    int n, std::chrono::system_clock::time_point& now_point) {
+  return std::unique_ptr<
+      gax::LimitedErrorCountRetryPolicy<gax::internal::TestClock>>(
+      new gax::LimitedErrorCountRetryPolicy<gax::internal::TestClock>(
+          n, std::chrono::milliseconds(2), now_point));
+}
+
+std::unique_ptr<gax::HedgingPolicy> FixedDelayFactory(
+    int max_hedged_attempts, std::chrono::milliseconds delay) {
+  return std::unique_ptr<gax::HedgingPolicy>(
+      new gax::FixedDelayHedgingPolicy(max_hedged_attempts, delay));
+}
+
+// Stands in for an rpc: completes after a delay, recording which attempt it
+// was in the response.
+class DelayedAttempt final : public gax::AsyncOperation {
+ public:
+  DelayedAttempt(int index, longrunning::Operation* response,
+                 std::function<void(gax::Status)> done)
+      : index_(index), response_(response), done_(std::move(done)) {}
+
+  grpc::ClientContext* grpc_context() { return &grpc_context_; }
+
+  void Set(grpc::CompletionQueue* cq, std::chrono::milliseconds delay) {
+    alarm_.Set(cq, std::chrono::system_clock::now() + delay, this);
+  }
+
+  void Notify(bool) override {
+    response_->set_name("attempt-" + std::to_string(index_));
+    done_(gax::Status{});
+  }
+
+ private:
+  int index_;
+  longrunning::Operation* response_;
+  std::function<void(gax::Status)> done_;
+  grpc::ClientContext grpc_context_;
+  grpc::Alarm alarm_;
+};
+
+// Attempt `n` takes `latencies[n]`, attempts beyond the list take the last.
+class FakeAsyncStub {
+ public:
+  explicit FakeAsyncStub(std::vector<std::chrono::milliseconds> latencies)
+      : latencies_(std::move(latencies)) {}
+
+  void operator()(gax::CallContext& context,
+                  longrunning::GetOperationRequest const&,
+                  longrunning::Operation* response, grpc::CompletionQueue* cq,
+                  std::function<void(gax::Status)> done) {
+    int index = attempts_++;
+    auto* attempt = new DelayedAttempt(index, response, std::move(done));
+    context.PrepareGrpcContext(attempt->grpc_context());
+    attempt->Set(cq, latencies_[std::min<std::size_t>(index,
+                                                      latencies_.size() - 1)]);
+  }
+
+  int attempts() const { return attempts_; }
+
+ private:
+  std::vector<std::chrono::milliseconds> latencies_;
+  int attempts_ = 0;
+};
+
+gax::MethodInfo const kMethodInfo{"TestMethod",
+                                  gax::MethodInfo::RpcType::NORMAL_RPC,
+                                  gax::MethodInfo::Idempotency::IDEMPOTENT};
+
+TEST(HedgedCall, SlowAttemptIsHedged) {
+  gax::CallContext context(kMethodInfo);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+  FakeAsyncStub stub(
+      {std::chrono::milliseconds(200), std::chrono::milliseconds(0)});
+
+  gax::Status status = gax::MakeHedgedCall(
+      context, req, &resp, std::ref(stub), ErrCountRetryFactory(3, now_point),
+      FixedDelayFactory(1, std::chrono::milliseconds(10)));
+  EXPECT_EQ(status, gax::Status{});
+  EXPECT_EQ(resp.name(), "attempt-1");
+  EXPECT_EQ(stub.attempts(), 2);
+}
+
+TEST(HedgedCall, FastAttemptIsNotHedged) {
+  gax::CallContext context(kMethodInfo);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+  FakeAsyncStub stub({std::chrono::milliseconds(0)});
+
+  gax::Status status = gax::MakeHedgedCall(
+      context, req, &resp, std::ref(stub), ErrCountRetryFactory(3, now_point),
+      FixedDelayFactory(3, std::chrono::hours(1)));
+  EXPECT_EQ(status, gax::Status{});
+  EXPECT_EQ(resp.name(), "attempt-0");
+  EXPECT_EQ(stub.attempts(), 1);
+}
+
+TEST(HedgedCall, MaxHedgedAttempts) {
+  gax::CallContext context(kMethodInfo);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+  FakeAsyncStub stub({std::chrono::milliseconds(100)});
+
+  gax::Status status = gax::MakeHedgedCall(
+      context, req, &resp, std::ref(stub), ErrCountRetryFactory(3, now_point),
+      FixedDelayFactory(2, std::chrono::milliseconds(1)));
+  EXPECT_EQ(status, gax::Status{});
+  EXPECT_EQ(stub.attempts(), 3);
+}
+
+TEST(HedgedCall, RetryBudget) {
+  gax::CallContext context(kMethodInfo);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+  FakeAsyncStub stub({std::chrono::milliseconds(100)});
+  gax::RetryBudget budget(1, 0.0);
+
+  gax::Status status = gax::MakeHedgedCall(
+      context, req, &resp, std::ref(stub), ErrCountRetryFactory(3, now_point),
+      FixedDelayFactory(5, std::chrono::milliseconds(1)), &budget);
+  EXPECT_EQ(status, gax::Status{});
+  EXPECT_EQ(stub.attempts(), 2);
+}
+
+TEST(HedgedCall, TransientFailure) {
+  gax::CallContext context(kMethodInfo);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+
+  int attempts = 0;
+  auto fail_first = [&attempts](gax::CallContext&,
+                                longrunning::GetOperationRequest const&,
+                                longrunning::Operation* resp,
+                                grpc::CompletionQueue*,
+                                std::function<void(gax::Status)> done) {
+    resp->set_name("attempt-" + std::to_string(attempts));
+    done((attempts++ == 0) ? gax::Status(gax::StatusCode::kAborted, "Aborted")
+                           : gax::Status{});
+  };
+
+  // The failure triggers the next attempt without waiting for the delay.
+  gax::Status status = gax::MakeHedgedCall(
+      context, req, &resp, fail_first, ErrCountRetryFactory(3, now_point),
+      FixedDelayFactory(1, std::chrono::hours(1)));
+  EXPECT_EQ(status, gax::Status{});
+  EXPECT_EQ(resp.name(), "attempt-1");
+  EXPECT_EQ(attempts, 2);
+
+  // Once the hedges are used up the last failure is reported.
+  attempts = 0;
+  auto always_fail = [&attempts](gax::CallContext&,
+                                 longrunning::GetOperationRequest const&,
+                                 longrunning::Operation*,
+                                 grpc::CompletionQueue*,
+                                 std::function<void(gax::Status)> done) {
+    attempts++;
+    done(gax::Status(gax::StatusCode::kAborted, "Aborted"));
+  };
+  gax::Status exhausted = gax::MakeHedgedCall(
+      context, req, &resp, always_fail, ErrCountRetryFactory(10, now_point),
+      FixedDelayFactory(2, std::chrono::hours(1)));
+  EXPECT_EQ(exhausted, gax::Status(gax::StatusCode::kAborted, "Aborted"));
+  EXPECT_EQ(attempts, 3);
+}
+
+TEST(HedgedCall, PermanentFailure) {
+  gax::CallContext context(kMethodInfo);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+
+  int attempts = 0;
+  auto not_found = [&attempts](gax::CallContext&,
+                               longrunning::GetOperationRequest const&,
+                               longrunning::Operation*, grpc::CompletionQueue*,
+                               std::function<void(gax::Status)> done) {
+    attempts++;
+    done(gax::Status(gax::StatusCode::kNotFound, "NotFound"));
+  };
+
+  gax::Status status = gax::MakeHedgedCall(
+      context, req, &resp, not_found, ErrCountRetryFactory(3, now_point),
+      FixedDelayFactory(3, std::chrono::hours(1)));
+  EXPECT_EQ(status, gax::Status(gax::StatusCode::kNotFound, "NotFound"));
+  EXPECT_EQ(attempts, 1);
+}
+
+TEST(AsyncHedgedCall, Basic) {
+  gax::CallContext context(kMethodInfo);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+  grpc::CompletionQueue cq;
+  std::thread runner(gax::RunCompletionQueue, &cq);
+  FakeAsyncStub stub(
+      {std::chrono::milliseconds(200), std::chrono::milliseconds(0)});
+
+  std::promise<gax::Status> result;
+  gax::MakeAsyncHedgedCall(
+      context, req, &resp, &cq, std::ref(stub),
+      ErrCountRetryFactory(3, now_point),
+      FixedDelayFactory(1, std::chrono::milliseconds(10)),
+      [&result](gax::Status s) { result.set_value(s); });
+  EXPECT_EQ(result.get_future().get(), gax::Status{});
+  EXPECT_EQ(resp.name(), "attempt-1");
+
+  cq.Shutdown();
+  runner.join();
+  EXPECT_EQ(stub.attempts(), 2);
+}
+
+}  // namespace
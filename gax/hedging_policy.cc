@@ -0,0 +1,65 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/hedging_policy.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace google {
+namespace gax {
+namespace internal {
+
+constexpr std::size_t LatencyTracker::kCapacity;
+
+void LatencyTracker::Record(std::chrono::microseconds latency) {
+  auto slot = next_.fetch_add(1, std::memory_order_relaxed) % kCapacity;
+  samples_[slot].store(latency.count(), std::memory_order_relaxed);
+}
+
+bool LatencyTracker::Percentile(double percentile, std::size_t min_samples,
+                                std::chrono::microseconds* result) const {
+  auto recorded = std::min<std::uint64_t>(
+      next_.load(std::memory_order_relaxed), kCapacity);
+  if (recorded == 0 || recorded < min_samples) {
+    return false;
+  }
+
+  std::vector<std::int64_t> snapshot;
+  snapshot.reserve(recorded);
+  for (std::size_t i = 0; i < recorded; ++i) {
+    snapshot.push_back(samples_[i].load(std::memory_order_relaxed));
+  }
+
+  auto rank = static_cast<std::size_t>(percentile / 100.0 * (recorded - 1));
+  rank = std::min<std::size_t>(rank, recorded - 1);
+  std::nth_element(snapshot.begin(), snapshot.begin() + rank, snapshot.end());
+  *result = std::chrono::microseconds(snapshot[rank]);
+  return true;
+}
+
+}  // namespace internal
+
+constexpr std::size_t LatencyPercentileHedgingPolicy::kMinSamples;
+
+std::chrono::microseconds LatencyPercentileHedgingPolicy::HedgingDelay() const {
+  std::chrono::microseconds estimate;
+  if (!tracker_->Percentile(percentile_, kMinSamples, &estimate)) {
+    return min_delay_;
+  }
+  return std::max(min_delay_, estimate);
+}
+
+}  // namespace gax
+}  // namespace google
@@ -0,0 +1,169 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GAPIC_GENERATOR_CPP_GAX_HEDGING_POLICY_H_
+#define GAPIC_GENERATOR_CPP_GAX_HEDGING_POLICY_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace google {
+namespace gax {
+
+/**
+ * Define the interface for hedging policies.
+ *
+ * Hedging sends additional attempts of an rpc while earlier attempts are still
+ * in flight, and uses whichever attempt succeeds first. This trades a small
+ * amount of extra traffic for lower tail latency. Since several attempts may
+ * reach the server, hedging is only ever applied to idempotent methods.
+ *
+ * Like retry and backoff policies, the application provides a prototype that
+ * is cloned for each operation.
+ */
+class HedgingPolicy {
+ public:
+  virtual ~HedgingPolicy() = default;
+
+  /**
+   * Return a new copy of this object.
+   */
+  virtual std::unique_ptr<HedgingPolicy> clone() const = 0;
+
+  /**
+   * The maximum number of attempts sent in addition to the first one.
+   */
+  virtual int MaxHedgedAttempts() const = 0;
+
+  /**
+   * How long to wait for outstanding attempts before sending the next one.
+   */
+  virtual std::chrono::microseconds HedgingDelay() const = 0;
+
+  /**
+   * Report the latency of a successful attempt.
+   *
+   * Policies that adapt their delay to observed latencies override this.
+   */
+  virtual void OnAttemptLatency(std::chrono::microseconds) {}
+};
+
+/**
+ * Send up to a fixed number of hedged attempts, a fixed delay apart.
+ */
+class FixedDelayHedgingPolicy final : public HedgingPolicy {
+ public:
+  template <typename Rep, typename Period>
+  FixedDelayHedgingPolicy(int max_hedged_attempts,
+                          std::chrono::duration<Rep, Period> delay)
+      : max_hedged_attempts_(max_hedged_attempts),
+        delay_(std::chrono::duration_cast<std::chrono::microseconds>(delay)) {}
+
+  std::unique_ptr<HedgingPolicy> clone() const override {
+    return std::unique_ptr<HedgingPolicy>(new FixedDelayHedgingPolicy(*this));
+  }
+
+  int MaxHedgedAttempts() const override { return max_hedged_attempts_; }
+
+  std::chrono::microseconds HedgingDelay() const override { return delay_; }
+
+ private:
+  int const max_hedged_attempts_;
+  std::chrono::microseconds const delay_;
+};
+
+namespace internal {
+
+/**
+ * A lock-free record of the most recent attempt latencies.
+ *
+ * Writers overwrite the oldest sample; readers take a racy but consistent
+ * enough snapshot to estimate a percentile.
+ */
+class LatencyTracker {
+ public:
+  static constexpr std::size_t kCapacity = 128;
+
+  LatencyTracker() : next_(0) {
+    for (auto& s : samples_) {
+      s.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void Record(std::chrono::microseconds latency);
+
+  /**
+   * Estimate the @p percentile (in [0, 100]) of the recorded latencies.
+   *
+   * @return false if fewer than @p min_samples latencies have been recorded.
+   */
+  bool Percentile(double percentile, std::size_t min_samples,
+                  std::chrono::microseconds* result) const;
+
+ private:
+  std::array<std::atomic<std::int64_t>, kCapacity> samples_;
+  std::atomic<std::uint64_t> next_;
+};
+
+}  // namespace internal
+
+/**
+ * Send a hedged attempt once outstanding attempts take longer than a given
+ * percentile of recently observed latencies.
+ *
+ * Until enough latencies have been observed, and whenever the estimate is
+ * smaller, @p min_delay is used instead. Clones share the latency history, so
+ * the prototype held by a client learns from all of its calls.
+ */
+class LatencyPercentileHedgingPolicy final : public HedgingPolicy {
+ public:
+  template <typename Rep, typename Period>
+  LatencyPercentileHedgingPolicy(int max_hedged_attempts, double percentile,
+                                 std::chrono::duration<Rep, Period> min_delay)
+      : max_hedged_attempts_(max_hedged_attempts),
+        percentile_(percentile),
+        min_delay_(
+            std::chrono::duration_cast<std::chrono::microseconds>(min_delay)),
+        tracker_(std::make_shared<internal::LatencyTracker>()) {}
+
+  std::unique_ptr<HedgingPolicy> clone() const override {
+    return std::unique_ptr<HedgingPolicy>(
+        new LatencyPercentileHedgingPolicy(*this));
+  }
+
+  int MaxHedgedAttempts() const override { return max_hedged_attempts_; }
+
+  std::chrono::microseconds HedgingDelay() const override;
+
+  void OnAttemptLatency(std::chrono::microseconds latency) override {
+    tracker_->Record(latency);
+  }
+
+ private:
+  // A percentile of very few samples is mostly noise.
+  static constexpr std::size_t kMinSamples = 16;
+
+  int const max_hedged_attempts_;
+  double const percentile_;
+  std::chrono::microseconds const min_delay_;
+  std::shared_ptr<internal::LatencyTracker> tracker_;
+};
+
+}  // namespace gax
+}  // namespace google
+
+#endif  // GAPIC_GENERATOR_CPP_GAX_HEDGING_POLICY_H_
@@ -0,0 +1,84 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/hedging_policy.h"
+#include <gtest/gtest.h>
+#include <chrono>
+
+namespace google {
+namespace gax {
+
+TEST(FixedDelayHedgingPolicy, Basic) {
+  FixedDelayHedgingPolicy policy(2, std::chrono::milliseconds(10));
+  EXPECT_EQ(policy.MaxHedgedAttempts(), 2);
+  EXPECT_EQ(policy.HedgingDelay(), std::chrono::milliseconds(10));
+
+  auto clone = policy.clone();
+  EXPECT_EQ(clone->MaxHedgedAttempts(), 2);
+  EXPECT_EQ(clone->HedgingDelay(), std::chrono::milliseconds(10));
+}
+
+TEST(LatencyTracker, Percentile) {
+  internal::LatencyTracker tracker;
+  std::chrono::microseconds result;
+  EXPECT_FALSE(tracker.Percentile(50, 1, &result));
+
+  for (int i = 1; i <= 100; ++i) {
+    tracker.Record(std::chrono::microseconds(i));
+  }
+  EXPECT_FALSE(tracker.Percentile(50, 101, &result));
+  ASSERT_TRUE(tracker.Percentile(0, 1, &result));
+  EXPECT_EQ(result, std::chrono::microseconds(1));
+  ASSERT_TRUE(tracker.Percentile(100, 1, &result));
+  EXPECT_EQ(result, std::chrono::microseconds(100));
+  ASSERT_TRUE(tracker.Percentile(90, 1, &result));
+  EXPECT_EQ(result, std::chrono::microseconds(90));
+}
+
+TEST(LatencyTracker, OverwritesOldest) {
+  internal::LatencyTracker tracker;
+  for (std::size_t i = 0; i < internal::LatencyTracker::kCapacity; ++i) {
+    tracker.Record(std::chrono::microseconds(1000));
+  }
+  for (std::size_t i = 0; i < internal::LatencyTracker::kCapacity; ++i) {
+    tracker.Record(std::chrono::microseconds(1));
+  }
+  std::chrono::microseconds result;
+  ASSERT_TRUE(tracker.Percentile(100, 1, &result));
+  EXPECT_EQ(result, std::chrono::microseconds(1));
+}
+
+TEST(LatencyPercentileHedgingPolicy, Basic) {
+  LatencyPercentileHedgingPolicy policy(1, 90, std::chrono::milliseconds(5));
+  EXPECT_EQ(policy.MaxHedgedAttempts(), 1);
+  // Not enough samples yet.
+  EXPECT_EQ(policy.HedgingDelay(), std::chrono::milliseconds(5));
+
+  // Clones share the latency history with the prototype.
+  auto clone = policy.clone();
+  for (int i = 0; i < 100; ++i) {
+    clone->OnAttemptLatency(std::chrono::milliseconds(50));
+  }
+  EXPECT_EQ(policy.HedgingDelay(), std::chrono::milliseconds(50));
+  EXPECT_EQ(clone->HedgingDelay(), std::chrono::milliseconds(50));
+
+  // Never hedge sooner than the minimum delay.
+  for (int i = 0; i < 200; ++i) {
+    policy.OnAttemptLatency(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(policy.HedgingDelay(), std::chrono::milliseconds(5));
+}
+
+}  // namespace gax
+}  // namespace google
@@ -0,0 +1,35 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GAPIC_GENERATOR_CPP_GAX_INTERNAL_ALLOCATION_COUNTER_H_
+#define GAPIC_GENERATOR_CPP_GAX_INTERNAL_ALLOCATION_COUNTER_H_
+
+namespace google {
+namespace gax {
+namespace internal {
+
+/**
+ * The number of heap allocations made by the program so far.
+ *
+ * Linking the allocation_counter test library replaces the global
+ * operator new and operator delete to maintain this count, so it must only
+ * be linked into tests.
+ */
+long AllocationCount();
+
+}  // namespace internal
+}  // namespace gax
+}  // namespace google
+
+#endif  // GAPIC_GENERATOR_CPP_GAX_INTERNAL_ALLOCATION_COUNTER_H_
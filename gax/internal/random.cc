@@ -0,0 +1,45 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/internal/random.h"
+#include <atomic>
+#include <cstdint>
+#include <random>
+
+namespace google {
+namespace gax {
+namespace internal {
+
+namespace {
+
+std::uint64_t NextThreadSeed() {
+  static std::uint64_t const process_seed = [] {
+    std::random_device rd;
+    return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+  }();
+  static std::atomic<std::uint64_t> thread_counter(0);
+  SplitMix64 mix(process_seed + thread_counter.fetch_add(1));
+  return mix();
+}
+
+}  // namespace
+
+Xoshiro256pp& ThreadLocalGenerator() {
+  static thread_local Xoshiro256pp generator(NextThreadSeed());
+  return generator;
+}
+
+}  // namespace internal
+}  // namespace gax
+}  // namespace google
@@ -0,0 +1,105 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GAPIC_GENERATOR_CPP_GAX_INTERNAL_RANDOM_H_
+#define GAPIC_GENERATOR_CPP_GAX_INTERNAL_RANDOM_H_
+
+#include <cstdint>
+#include <limits>
+
+namespace google {
+namespace gax {
+namespace internal {
+
+/**
+ * The SplitMix64 generator, used to expand a single seed into the state of a
+ * larger generator.
+ *
+ * @see http://prng.di.unimi.it/splitmix64.c
+ */
+class SplitMix64 {
+ public:
+  explicit SplitMix64(std::uint64_t seed) : state_(seed) {}
+
+  std::uint64_t operator()() {
+    std::uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+ private:
+  std::uint64_t state_;
+};
+
+/**
+ * The xoshiro256++ generator.
+ *
+ * A small (32 byte) and fast generator of good statistical quality, meant for
+ * jitter and other uses that do not need cryptographic randomness. It
+ * satisfies UniformRandomBitGenerator, so it works with the <random>
+ * distributions.
+ *
+ * @see http://prng.di.unimi.it/xoshiro256plusplus.c
+ */
+class Xoshiro256pp {
+ public:
+  using result_type = std::uint64_t;
+
+  explicit Xoshiro256pp(std::uint64_t seed) {
+    SplitMix64 seeder(seed);
+    for (auto& s : s_) {
+      s = seeder();
+    }
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()() {
+    result_type const result = Rotl(s_[0] + s_[3], 23) + s_[0];
+    result_type const t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = Rotl(s_[3], 45);
+    return result;
+  }
+
+ private:
+  static result_type Rotl(result_type x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  result_type s_[4];
+};
+
+/**
+ * The calling thread's generator.
+ *
+ * Each thread's generator is created on first use, from a seed that combines
+ * a per-process random value with a per-thread counter; only the first call in
+ * the process reads std::random_device.
+ */
+Xoshiro256pp& ThreadLocalGenerator();
+
+}  // namespace internal
+}  // namespace gax
+}  // namespace google
+
+#endif  // GAPIC_GENERATOR_CPP_GAX_INTERNAL_RANDOM_H_
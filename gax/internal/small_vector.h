@@ -0,0 +1,167 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GAPIC_GENERATOR_CPP_GAX_INTERNAL_SMALL_VECTOR_H_
+#define GAPIC_GENERATOR_CPP_GAX_INTERNAL_SMALL_VECTOR_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace gax {
+namespace internal {
+
+/**
+ * A vector that stores up to @p N elements inline and only allocates once it
+ * grows past them.
+ *
+ * This covers just what the library needs: appending, iterating, and copying
+ * or moving the whole container. Elements are contiguous in either mode.
+ */
+template <typename T, std::size_t N>
+class SmallVector {
+  static_assert(N > 0, "use std::vector<T> when there is no inline storage");
+
+ public:
+  using value_type = T;
+  using iterator = T*;
+  using const_iterator = T const*;
+
+  SmallVector() : size_(0) {}
+
+  SmallVector(SmallVector const& rhs) : size_(0) {
+    if (rhs.size() > N) {
+      heap_ = rhs.heap_;
+      return;
+    }
+    for (auto const& v : rhs) {
+      emplace_back(v);
+    }
+  }
+
+  SmallVector(SmallVector&& rhs) noexcept(
+      std::is_nothrow_move_constructible<T>::value)
+      : size_(0) {
+    MoveFrom(rhs);
+  }
+
+  SmallVector& operator=(SmallVector const& rhs) {
+    if (this != &rhs) {
+      SmallVector tmp(rhs);
+      clear();
+      MoveFrom(tmp);
+    }
+    return *this;
+  }
+
+  SmallVector& operator=(SmallVector&& rhs) noexcept(
+      std::is_nothrow_move_constructible<T>::value) {
+    if (this != &rhs) {
+      clear();
+      MoveFrom(rhs);
+    }
+    return *this;
+  }
+
+  ~SmallVector() { clear(); }
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    if (heap_.empty() && size_ < N) {
+      T* p = ::new (static_cast<void*>(InlineData() + size_))
+          T(std::forward<Args>(args)...);
+      ++size_;
+      return *p;
+    }
+    if (heap_.empty()) {
+      // Construct the new element before spilling the inline elements to the
+      // heap, as @p args may refer to one of them.
+      T value(std::forward<Args>(args)...);
+      heap_.reserve(2 * N);
+      for (std::size_t i = 0; i != size_; ++i) {
+        heap_.emplace_back(std::move(InlineData()[i]));
+      }
+      DestroyInline();
+      heap_.emplace_back(std::move(value));
+      return heap_.back();
+    }
+    heap_.emplace_back(std::forward<Args>(args)...);
+    return heap_.back();
+  }
+
+  void push_back(T const& v) { emplace_back(v); }
+  void push_back(T&& v) { emplace_back(std::move(v)); }
+
+  std::size_t size() const { return heap_.empty() ? size_ : heap_.size(); }
+  bool empty() const { return size() == 0; }
+
+  /// True while the elements are stored inline.
+  bool is_inline() const { return heap_.empty(); }
+
+  T* begin() { return heap_.empty() ? InlineData() : heap_.data(); }
+  T* end() { return begin() + size(); }
+  T const* begin() const {
+    return heap_.empty() ? InlineData() : heap_.data();
+  }
+  T const* end() const { return begin() + size(); }
+
+  T& operator[](std::size_t i) { return begin()[i]; }
+  T const& operator[](std::size_t i) const { return begin()[i]; }
+
+  void clear() {
+    DestroyInline();
+    std::vector<T>().swap(heap_);
+  }
+
+ private:
+  T* InlineData() { return reinterpret_cast<T*>(&inline_[0]); }
+  T const* InlineData() const {
+    return reinterpret_cast<T const*>(&inline_[0]);
+  }
+
+  void DestroyInline() {
+    for (std::size_t i = 0; i != size_; ++i) {
+      InlineData()[i].~T();
+    }
+    size_ = 0;
+  }
+
+  // Pre-condition: this container is empty.
+  void MoveFrom(SmallVector& rhs) {
+    if (!rhs.heap_.empty()) {
+      heap_.swap(rhs.heap_);
+      return;
+    }
+    for (std::size_t i = 0; i != rhs.size_; ++i) {
+      ::new (static_cast<void*>(InlineData() + i))
+          T(std::move(rhs.InlineData()[i]));
+      ++size_;
+    }
+    rhs.DestroyInline();
+  }
+
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type inline_[N];
+  // The number of inline elements, zero once spilled to heap_.
+  std::size_t size_;
+  std::vector<T> heap_;
+};
+
+}  // namespace internal
+}  // namespace gax
+}  // namespace google
+
+#endif  // GAPIC_GENERATOR_CPP_GAX_INTERNAL_SMALL_VECTOR_H_
@@ -0,0 +1,107 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/internal/small_vector.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace gax {
+namespace internal {
+namespace {
+
+std::vector<std::string> Contents(SmallVector<std::string, 2> const& v) {
+  return std::vector<std::string>(v.begin(), v.end());
+}
+
+TEST(SmallVector, InlineThenHeap) {
+  SmallVector<std::string, 2> v;
+  EXPECT_TRUE(v.empty());
+  v.push_back("a");
+  v.emplace_back("b");
+  EXPECT_TRUE(v.is_inline());
+  EXPECT_EQ(Contents(v), (std::vector<std::string>{"a", "b"}));
+
+  v.emplace_back("c");
+  EXPECT_FALSE(v.is_inline());
+  EXPECT_EQ(v.size(), 3u);
+  EXPECT_EQ(v[2], "c");
+  EXPECT_EQ(Contents(v), (std::vector<std::string>{"a", "b", "c"}));
+
+  v.clear();
+  EXPECT_TRUE(v.empty());
+  EXPECT_TRUE(v.is_inline());
+}
+
+TEST(SmallVector, PushBackOwnElement) {
+  // Long enough that a destroyed string would not keep its characters.
+  std::string const first(64, 'a');
+  SmallVector<std::string, 2> v;
+  v.push_back(first);
+  v.push_back("b");
+  // The inline elements are moved to the heap by this call.
+  v.push_back(v[0]);
+  EXPECT_FALSE(v.is_inline());
+  EXPECT_EQ(Contents(v), (std::vector<std::string>{first, "b", first}));
+
+  v.emplace_back(v[1]);
+  EXPECT_EQ(v[3], "b");
+}
+
+TEST(SmallVector, CopyAndMove) {
+  SmallVector<std::string, 2> small;
+  small.push_back("a");
+  SmallVector<std::string, 2> large;
+  for (auto const* s : {"a", "b", "c"}) {
+    large.push_back(s);
+  }
+
+  SmallVector<std::string, 2> small_copy(small);
+  SmallVector<std::string, 2> large_copy(large);
+  EXPECT_EQ(Contents(small_copy), Contents(small));
+  EXPECT_EQ(Contents(large_copy), Contents(large));
+
+  SmallVector<std::string, 2> small_moved(std::move(small_copy));
+  SmallVector<std::string, 2> large_moved(std::move(large_copy));
+  EXPECT_EQ(Contents(small_moved), Contents(small));
+  EXPECT_EQ(Contents(large_moved), Contents(large));
+  EXPECT_TRUE(small_copy.empty());
+  EXPECT_TRUE(large_copy.empty());
+
+  small_moved = large;
+  EXPECT_EQ(Contents(small_moved), Contents(large));
+  large_moved = std::move(small);
+  EXPECT_EQ(Contents(large_moved), (std::vector<std::string>{"a"}));
+}
+
+TEST(SmallVector, DestroysElements) {
+  auto counter = std::make_shared<int>(0);
+  {
+    SmallVector<std::shared_ptr<int>, 2> v;
+    v.push_back(counter);
+    EXPECT_EQ(counter.use_count(), 2);
+    v.push_back(counter);
+    v.push_back(counter);
+    EXPECT_EQ(counter.use_count(), 4);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace gax
+}  // namespace google
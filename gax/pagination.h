@@ -15,16 +15,283 @@
 #ifndef GAPIC_GENERATOR_CPP_GAX_PAGINATION_H_
 #define GAPIC_GENERATOR_CPP_GAX_PAGINATION_H_
 
+#include "gax/adaptive_page_size.h"
+#include "gax/backoff_policy.h"
 #include "gax/internal/invoke_result.h"
+#include "gax/retry_loop.h"
+#include "gax/retry_policy.h"
 #include "gax/status.h"
+#include <google/protobuf/arena.h>
 #include <google/protobuf/repeated_field.h>
+#include <cstddef>
+#include <chrono>
+#include <condition_variable>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <type_traits>
 
 namespace google {
 namespace gax {
 
+/**
+ * Tuning knobs for Pages.
+ */
+struct PagesOptions {
+  /// Fetch the next page on a background thread while the caller is still
+  /// processing the current one.
+  bool prefetch = false;
+
+  /// If non-zero, each page is allocated on a protobuf::Arena that is reset
+  /// before the next page is fetched into it. The arena's first block has
+  /// this size and is reused for every page. With `prefetch`, two such
+  /// arenas alternate.
+  ///
+  /// This does not reduce the number of allocations: the characters of
+  /// string fields are still allocated on the heap, and, unlike the default
+  /// mode, where the page is cleared and its storage reused, that happens
+  /// again for every page. Arena pages trade that allocation count for
+  /// freeing each page in bulk and memory bounded by the arena's blocks,
+  /// which pays off for deep pages.
+  std::size_t arena_block_size = 0;
+
+  /// If set, a failed page fetch is retried while this policy allows it. Each
+  /// page gets a fresh copy of the policy. The retriever must only advance
+  /// its page token when a fetch succeeds, so a retry requests the same page.
+  std::shared_ptr<RetryPolicy const> retry_policy;
+
+  /// The delay between retries of a page fetch. Retries are immediate if
+  /// unset. A google.rpc.RetryInfo sent by the server takes precedence.
+  std::shared_ptr<BackoffPolicy const> backoff_policy;
+
+  /// If set, receives the latency and size of every page and the time the
+  /// caller spends on it. The retriever should take the page size of each
+  /// request from it.
+  std::shared_ptr<AdaptivePageSize> page_size_controller;
+};
+
+namespace internal {
+
+/**
+ * Storage for one page message, optionally on a reusable arena.
+ *
+ * Copies are always heap allocated; moves keep the arena.
+ */
+template <typename PageType>
+class PageBuffer {
+ public:
+  explicit PageBuffer(std::size_t arena_block_size = 0) : page_(&heap_page_) {
+    if (arena_block_size != 0) {
+      block_.reset(new char[arena_block_size]);
+      protobuf::ArenaOptions options;
+      options.initial_block = block_.get();
+      options.initial_block_size = arena_block_size;
+      arena_.reset(new protobuf::Arena(options));
+    }
+  }
+  explicit PageBuffer(PageType const& page)
+      : heap_page_(page), page_(&heap_page_) {}
+  explicit PageBuffer(PageType&& page)
+      : heap_page_(std::move(page)), page_(&heap_page_) {}
+
+  PageBuffer(PageBuffer const& rhs)
+      : heap_page_(*rhs.page_), page_(&heap_page_) {}
+  PageBuffer(PageBuffer&& rhs) noexcept : page_(&heap_page_) {
+    *this = std::move(rhs);
+  }
+  PageBuffer& operator=(PageBuffer const& rhs) {
+    PageBuffer tmp(rhs);
+    return *this = std::move(tmp);
+  }
+  PageBuffer& operator=(PageBuffer&& rhs) noexcept {
+    heap_page_.Swap(&rhs.heap_page_);
+    block_.swap(rhs.block_);
+    arena_.swap(rhs.arena_);
+    std::swap(page_, rhs.page_);
+    if (!arena_) {
+      page_ = &heap_page_;
+    }
+    if (!rhs.arena_) {
+      rhs.page_ = &rhs.heap_page_;
+    }
+    return *this;
+  }
+
+  PageType& page() { return *page_; }
+  PageType const& page() const { return *page_; }
+
+  /// Discard the current page and return an empty one to fetch into.
+  PageType* Reset() {
+    if (!arena_) {
+      heap_page_.Clear();
+      return page_;
+    }
+    arena_->Reset();
+    page_ = protobuf::Arena::CreateMessage<PageType>(arena_.get());
+    return page_;
+  }
+
+  void swap(PageBuffer& rhs) noexcept {
+    PageBuffer tmp(std::move(rhs));
+    rhs = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+ private:
+  PageType heap_page_;
+  // Declared before arena_ so it outlives it.
+  std::unique_ptr<char[]> block_;
+  std::unique_ptr<protobuf::Arena> arena_;
+  PageType* page_;
+};
+
+/**
+ * Make a single attempt to fetch the next page into @p page.
+ */
+template <typename PageType, typename NextPageRetriever>
+Status FetchPageAttempt(NextPageRetriever& get_next_page,
+                        PageBuffer<PageType>* page,
+                        PagesOptions const& options) {
+  auto const& controller = options.page_size_controller;
+  if (!controller) {
+    return get_next_page(page->Reset());
+  }
+  auto start = std::chrono::steady_clock::now();
+  Status status = get_next_page(page->Reset());
+  if (status.IsOk()) {
+    controller->OnPageFetched(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start),
+        page->page().ByteSizeLong());
+  }
+  return status;
+}
+
+/**
+ * Fetch the next page into @p page, retrying as configured in @p options.
+ *
+ * The policies are only cloned once a fetch fails.
+ */
+template <typename PageType, typename NextPageRetriever>
+Status FetchPage(NextPageRetriever& get_next_page, PageBuffer<PageType>* page,
+                 PagesOptions const& options) {
+  Status status = FetchPageAttempt(get_next_page, page, options);
+  if (status.IsOk()) {
+    return status;
+  }
+  if (!options.retry_policy) {
+    page->Reset();
+    return status;
+  }
+  auto retry_policy = options.retry_policy->clone();
+  std::unique_ptr<BackoffPolicy> backoff_policy;
+  if (options.backoff_policy) {
+    backoff_policy = options.backoff_policy->clone();
+  }
+  while (ShouldRetry(status, *retry_policy, nullptr)) {
+    if (backoff_policy) {
+      std::this_thread::sleep_for(NextBackoff(status, *backoff_policy));
+    }
+    status = FetchPageAttempt(get_next_page, page, options);
+  }
+  if (!status.IsOk()) {
+    // Make sure the failed page ends the iteration.
+    page->Reset();
+  }
+  return status;
+}
+
+/**
+ * Fetches the next page of a Pages sequence on a background thread.
+ *
+ * Each prefetcher owns one worker thread for its whole lifetime, so a long
+ * listing does not pay for a thread per page. At most one fetch is in flight
+ * at a time, so the retriever is never called concurrently with itself, but
+ * it is called from a thread other than the one iterating.
+ */
+template <typename PageType, typename NextPageRetriever>
+class PagePrefetcher {
+ public:
+  PagePrefetcher(NextPageRetriever get_next_page, PagesOptions options)
+      : get_next_page_(std::move(get_next_page)),
+        options_(std::move(options)),
+        spare_(options_.arena_block_size),
+        pending_(false),
+        ready_(false),
+        shutdown_(false),
+        worker_([this] { Run(); }) {}
+
+  PagePrefetcher(PagePrefetcher const&) = delete;
+  PagePrefetcher& operator=(PagePrefetcher const&) = delete;
+
+  /// Waits for a fetch already in flight; a requested one is not started.
+  ~PagePrefetcher() {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      shutdown_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+  }
+
+  /// Start fetching the next page into the spare buffer.
+  void Start() {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      pending_ = true;
+      ready_ = false;
+    }
+    cv_.notify_all();
+  }
+
+  /// Replace @p page with the next page, waiting for it if it was prefetched.
+  Status Next(PageBuffer<PageType>* page) {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (!pending_) {
+      lk.unlock();
+      return FetchPage(get_next_page_, page, options_);
+    }
+    cv_.wait(lk, [this] { return ready_; });
+    pending_ = false;
+    page->swap(spare_);
+    return std::move(status_);
+  }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lk(mu_);
+    while (true) {
+      cv_.wait(lk, [this] { return shutdown_ || (pending_ && !ready_); });
+      if (shutdown_) {
+        return;
+      }
+      lk.unlock();
+      Status status = FetchPage(get_next_page_, &spare_, options_);
+      lk.lock();
+      status_ = std::move(status);
+      ready_ = true;
+      cv_.notify_all();
+    }
+  }
+
+  NextPageRetriever get_next_page_;
+  PagesOptions const options_;
+  PageBuffer<PageType> spare_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  // A fetch was requested by Start() and not yet handed out by Next().
+  bool pending_;
+  // The requested fetch has completed with status_.
+  bool ready_;
+  bool shutdown_;
+  Status status_;
+  // Declared last so it starts once the rest is initialized.
+  std::thread worker_;
+};
+}  // namespace internal
+
 /**
  * Wraps a 'page' message with a consistent interface that provides an iterator
  * over its repeated elements and an accessor for its next_page_token field.
@@ -83,13 +350,15 @@ class PageResult {
 
   PageResult(PageType const& raw_page) : raw_page_(raw_page) {}
   PageResult(PageType&& raw_page) : raw_page_(std::move(raw_page)) {}
+  explicit PageResult(internal::PageBuffer<PageType> raw_page)
+      : raw_page_(std::move(raw_page)) {}
 
-  iterator begin() { return ElementAccessor{}(raw_page_)->begin(); }
-  iterator end() { return ElementAccessor{}(raw_page_)->end(); }
+  iterator begin() { return ElementAccessor{}(RawPage())->begin(); }
+  iterator end() { return ElementAccessor{}(RawPage())->end(); }
 
   // Const overloads
-  iterator begin() const { return ElementAccessor{}(raw_page_)->cbegin(); }
-  iterator end() const { return ElementAccessor{}(raw_page_)->cend(); }
+  iterator begin() const { return ElementAccessor{}(RawPage())->cbegin(); }
+  iterator end() const { return ElementAccessor{}(RawPage())->cend(); }
 
   /**
    * @brief Get the next_page_token for the page.
@@ -97,7 +366,9 @@ class PageResult {
    * @retun the token for the next page in the sequence
    * or the empty string if this is the last page.
    */
-  std::string NextPageToken() const { return raw_page_.next_page_token(); }
+  std::string const& NextPageToken() const {
+    return RawPage().next_page_token();
+  }
 
   /**
    * @brief Get the underlying page message.
@@ -107,13 +378,16 @@ class PageResult {
    *
    * @return a const reference to the underlying raw page.
    */
-  PageType const& RawPage() const { return raw_page_; }
+  PageType const& RawPage() const { return raw_page_.page(); }
 
   // Note: the non-const variant is intended for internal use only.
-  PageType& RawPage() { return raw_page_; }
+  PageType& RawPage() { return raw_page_.page(); }
+
+  // Note: intended for internal use only.
+  internal::PageBuffer<PageType>& Buffer() { return raw_page_; }
 
  private:
-  PageType raw_page_;
+  internal::PageBuffer<PageType> raw_page_;
 };
 
 /**
@@ -143,7 +417,9 @@ class PageResult {
  * {
  *   gax::CallContext ctx;
  *   gax::Status status = stub->ListElements(context, request, response);
- *   request.set_next_page_token(response->next_page_token());
+ *   if (status.IsOk()) {
+ *     request.set_next_page_token(response->next_page_token());
+ *   }
  *   return status;
  * };
  *
@@ -168,6 +444,13 @@ class PageResult {
  * Note: the initial page request MUST be captured by value in the
  * NextPageRetriever functor so that calling begin() multiple times on a Pages
  * instance results in valid behavior.
+ *
+ * With `PagesOptions::prefetch` set, the iterator starts fetching page N+1 as
+ * soon as page N arrives, so the rpc overlaps the caller's work on page N. The
+ * retriever is then called from a background thread.
+ *
+ * A page fetch that fails, after any retries configured in PagesOptions,
+ * ends the iteration. The error is available from status().
  */
 template <typename ElementType, typename PageType, typename ElementAccessor,
           typename NextPageRetriever,
@@ -179,47 +462,137 @@ template <typename ElementType, typename PageType, typename ElementAccessor,
               0>
 class Pages {
  public:
+  /**
+   * An input iterator over the pages.
+   *
+   * Copies of an iterator share the same position, so advancing one advances
+   * all of them. A default-constructed iterator is the end sentinel; it is
+   * cheap to create and compares equal to any iterator on the last page.
+   */
   class iterator {
    public:
     using PageResultT = PageResult<ElementType, PageType, ElementAccessor>;
-    using iterator_category = std::forward_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
     using value_type = PageResultT;
     using difference_type = std::ptrdiff_t;
     using pointer = PageResultT*;
     using reference = PageResultT&;
 
-    PageResultT const& operator*() const { return page_result_; }
-    PageResultT const* operator->() const { return &page_result_; }
+    iterator() = default;
+
+    PageResultT const& operator*() const {
+      return state_ ? state_->page_result : EmptyPage();
+    }
+    PageResultT const* operator->() const { return &**this; }
     iterator& operator++() {
-      // Note: if the rpc fails, the page will be untouched,
+      // Note: if the rpc fails, the page will be empty,
       // i.e. will have an empty page token and element collection.
       // This invalidates any iterators on the PageResult.
-      page_result_.RawPage().Clear();
-      get_next_page_(&(page_result_.RawPage()));
-      num_pages_++;
+      State& s = *state_;
+      auto const& controller = s.options.page_size_controller;
+      if (controller) {
+        controller->OnPageConsumed(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - s.page_ready));
+      }
+      Status status =
+          s.prefetcher ? s.prefetcher->Next(&s.page_result.Buffer())
+                       : internal::FetchPage(s.get_next_page,
+                                             &s.page_result.Buffer(),
+                                             s.options);
+      if (s.status) {
+        *s.status = std::move(status);
+      }
+      s.num_pages++;
+      MaybePrefetch();
+      if (controller) {
+        s.page_ready = std::chrono::steady_clock::now();
+      }
       return *this;
     }
 
-    // Just want to compare against end()
+    // Only meaningful against end(), or between copies of one iterator.
     bool operator==(iterator const& rhs) const {
-      return num_pages_ == rhs.num_pages_ ||
-             page_result_.NextPageToken() == rhs.page_result_.NextPageToken();
+      if (!state_ || !rhs.state_) {
+        return !HasNextPage() && !rhs.HasNextPage();
+      }
+      return state_ == rhs.state_;
     }
     bool operator!=(iterator const& rhs) const { return !(*this == rhs); }
 
+    /**
+     * Whether advancing the iterator fetches another page, i.e. the current
+     * page has a next page token and the page cap has not been reached.
+     */
+    bool HasNextPage() const {
+      return state_ &&
+             !state_->page_result.RawPage().next_page_token().empty() &&
+             (state_->pages_cap == 0 || state_->num_pages < state_->pages_cap);
+    }
+
+    // Note: intended for internal use only.
+    PageResultT& CurrentPage() { return state_->page_result; }
+
    private:
     friend Pages;
+    using Prefetcher = internal::PagePrefetcher<PageType, NextPageRetriever>;
+
+    // Everything the copies of an iterator share. Allocated once per begin(),
+    // advancing reuses it.
+    struct State {
+      State(internal::PageBuffer<PageType> page, NextPageRetriever g,
+            int cap, PagesOptions o, std::shared_ptr<Status> s)
+          : page_result(std::move(page)),
+            get_next_page(std::move(g)),
+            num_pages(1),
+            pages_cap(cap),
+            options(std::move(o)),
+            status(std::move(s)) {}
+
+      PageResultT page_result;
+      NextPageRetriever get_next_page;
+      int num_pages;
+      int pages_cap;
+      PagesOptions options;
+      // Shared with the Pages instance that created the iterator.
+      std::shared_ptr<Status> status;
+      // When the current page was handed to the caller.
+      std::chrono::steady_clock::time_point page_ready;
+      std::unique_ptr<Prefetcher> prefetcher;
+    };
+
     // Note: copying a message with many repeated elements is expensive.
     // Callers should move pages in when instantiating an iterator.
-    iterator(PageType page_result, NextPageRetriever get_next_page,
-             int num_pages)
-        : page_result_(std::move(page_result)),
-          get_next_page_(std::move(get_next_page)),
-          num_pages_(num_pages) {}
-
-    PageResultT page_result_;
-    NextPageRetriever get_next_page_;
-    int num_pages_;
+    iterator(internal::PageBuffer<PageType> page_result,
+             NextPageRetriever get_next_page, int pages_cap,
+             PagesOptions options, std::shared_ptr<Status> status)
+        : state_(std::make_shared<State>(
+              std::move(page_result), std::move(get_next_page), pages_cap,
+              std::move(options), std::move(status))) {
+      if (state_->options.page_size_controller) {
+        state_->page_ready = std::chrono::steady_clock::now();
+      }
+      if (state_->options.prefetch) {
+        state_->prefetcher.reset(new Prefetcher(
+            std::move(state_->get_next_page), state_->options));
+        MaybePrefetch();
+      }
+    }
+
+    // What the end sentinel dereferences to: a page without a token.
+    static PageResultT const& EmptyPage() {
+      static PageResultT const empty{PageType()};
+      return empty;
+    }
+
+    // Only fetch pages the synchronous iterator would also have fetched.
+    void MaybePrefetch() {
+      if (state_->prefetcher && HasNextPage()) {
+        state_->prefetcher->Start();
+      }
+    }
+
+    std::shared_ptr<State> state_;
   };
 
   /**
@@ -229,22 +602,35 @@ class Pages {
    * @param get_next_page an instance of the page retrieval functor.
    * @param pages_cap the maximum number of pages to retrieve. A value of 0
    * (default) indicates no cap.
+   * @param options controls how pages are fetched.
    */
-  Pages(NextPageRetriever get_next_page, int pages_cap = 0)
-      : get_next_page_(std::move(get_next_page)), pages_cap_(pages_cap) {}
+  Pages(NextPageRetriever get_next_page, int pages_cap = 0,
+        PagesOptions options = PagesOptions())
+      : get_next_page_(std::move(get_next_page)),
+        pages_cap_(pages_cap),
+        options_(std::move(options)) {}
 
   iterator begin() const {
-    PageType page;
+    internal::PageBuffer<PageType> page(options_.arena_block_size);
     // Copying the next-page lambda is necessary to start at the beginning.
     NextPageRetriever fresh_get_next_page_(get_next_page_);
-    fresh_get_next_page_(&page);
+    status_ = std::make_shared<Status>(
+        internal::FetchPage(fresh_get_next_page_, &page, options_));
 
-    return iterator(std::move(page), std::move(fresh_get_next_page_), 1);
+    return iterator(std::move(page), std::move(fresh_get_next_page_),
+                    pages_cap_, options_, status_);
   }
 
-  iterator end() const {
-    return iterator{PageType{}, get_next_page_, pages_cap_};
-  }
+  iterator end() const { return iterator(); }
+
+  /**
+   * The status of the most recent page fetch made by the iterators of the
+   * latest begin() call.
+   *
+   * Iteration ends early when a page cannot be fetched; in that case this
+   * returns the error, otherwise it is OK.
+   */
+  Status status() const { return status_ ? *status_ : Status(); }
 
  private:
   // Note: be sure to capture the initial page request by value so that calling
@@ -254,6 +640,118 @@ class Pages {
   // which means that begin() _really_ starts at the beginning.
   NextPageRetriever get_next_page_;
   const int pages_cap_;
+  PagesOptions const options_;
+  mutable std::shared_ptr<Status> status_;
+};
+
+/**
+ * A single-pass range over the elements of every page in a Pages sequence.
+ *
+ * Pages are fetched on demand: the next page is only requested when the
+ * iterator is advanced past the last element of the current one, so a caller
+ * that stops early never pays for a page it does not look at. Empty pages are
+ * skipped, and iteration ends after the last element of the page that has no
+ * next page token, or of the page at the page cap.
+ *
+ * Elements are yielded by mutable reference, so they can be moved out:
+ *
+ * @code
+ * PaginatedResult<Element, ListElementsResponse, ElementsAccessor,
+ *                 decltype(get_next_page)> elements(get_next_page);
+ * std::vector<Element> first;
+ * for (auto& e : elements) {
+ *   first.push_back(std::move(e));
+ *   if (first.size() == 10) break;  // No further page is fetched.
+ * }
+ * @endcode
+ *
+ * The template parameters and constructor arguments are those of Pages. As
+ * with any input iterator, advancing an iterator invalidates its copies: once
+ * one copy moves past a page, the others refer to a page that was recycled.
+ */
+template <typename ElementType, typename PageType, typename ElementAccessor,
+          typename NextPageRetriever>
+class PaginatedResult {
+  using PagesT =
+      Pages<ElementType, PageType, ElementAccessor, NextPageRetriever>;
+  using FieldIterator =
+      typename std::remove_pointer<typename gax::internal::invoke_result_t<
+          ElementAccessor, PageType&>>::type::iterator;
+
+ public:
+  class iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = ElementType;
+    using difference_type = std::ptrdiff_t;
+    using pointer = ElementType*;
+    using reference = ElementType&;
+
+    ElementType& operator*() const { return *current_; }
+    ElementType* operator->() const { return &(*current_); }
+    iterator& operator++() {
+      ++current_;
+      SkipExhaustedPages();
+      return *this;
+    }
+
+    bool operator==(iterator const& rhs) const {
+      return done_ == rhs.done_ && (done_ || current_ == rhs.current_);
+    }
+    bool operator!=(iterator const& rhs) const { return !(*this == rhs); }
+
+   private:
+    friend PaginatedResult;
+    using PageIterator = typename PagesT::iterator;
+
+    iterator() : done_(true) {}
+    explicit iterator(PageIterator page)
+        : page_(std::move(page)), done_(false) {
+      SetPage();
+      SkipExhaustedPages();
+    }
+
+    void SetPage() {
+      auto* elements = ElementAccessor{}(page_.CurrentPage().RawPage());
+      current_ = elements->begin();
+      end_ = elements->end();
+    }
+
+    // Fetch pages until there is an element to yield or there are no more
+    // pages.
+    void SkipExhaustedPages() {
+      while (current_ == end_) {
+        if (!page_.HasNextPage()) {
+          page_ = PageIterator();
+          done_ = true;
+          return;
+        }
+        ++page_;
+        SetPage();
+      }
+    }
+
+    PageIterator page_;
+    bool done_;
+    FieldIterator current_;
+    FieldIterator end_;
+  };
+
+  PaginatedResult(NextPageRetriever get_next_page, int pages_cap = 0,
+                  PagesOptions options = PagesOptions())
+      : pages_(std::move(get_next_page), pages_cap, std::move(options)) {}
+
+  iterator begin() const { return iterator(pages_.begin()); }
+  iterator end() const { return iterator(); }
+
+  /**
+   * OK unless the latest iteration ended early because a page could not be
+   * fetched.
+   */
+  Status status() const { return pages_.status(); }
+
+ private:
+  PagesT pages_;
 };
 
 }  // namespace gax
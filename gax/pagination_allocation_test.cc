@@ -0,0 +1,136 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/longrunning/operations.pb.h"
+#include "gax/internal/allocation_counter.h"
+#include "gax/pagination.h"
+#include "gax/status.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+
+namespace {
+using namespace ::google;
+
+class OperationsAccessor {
+ public:
+  protobuf::RepeatedPtrField<longrunning::Operation>* operator()(
+      longrunning::ListOperationsResponse& lor) const {
+    return lor.mutable_operations();
+  }
+};
+
+// Behaves like a generated retriever: it owns a copy of the request and
+// advances its page token. Tokens and names are too long for the small
+// string optimization, as they are in practice.
+class BenchmarkRetriever {
+ public:
+  explicit BenchmarkRetriever(int pages)
+      : name_("projects/my-project/locations/us-central1/operations/op"),
+        token_("CiAKGjBpNDd2Nmp2Zml2cXRwYjBpOXA4MHFhbDUSBggBEAEYAQ=="),
+        pages_(pages),
+        page_(0) {
+    request_.set_name("projects/my-project/locations/us-central1/operations");
+    request_.set_filter("done = true AND metadata.type = \"long-running\"");
+  }
+
+  gax::Status operator()(longrunning::ListOperationsResponse* lor) {
+    for (int i = 0; i != 10; ++i) {
+      lor->add_operations()->set_name(name_);
+    }
+    if (++page_ < pages_) {
+      lor->set_next_page_token(token_);
+      request_.set_page_token(lor->next_page_token());
+    }
+    return gax::Status();
+  }
+
+ private:
+  longrunning::ListOperationsRequest request_;
+  // Setting a field from a char const* would allocate a temporary string.
+  std::string name_;
+  std::string token_;
+  int pages_;
+  int page_;
+};
+
+using BenchmarkPages =
+    gax::Pages<longrunning::Operation, longrunning::ListOperationsResponse,
+               OperationsAccessor, BenchmarkRetriever>;
+
+struct Transitions {
+  double allocations_per_page;
+  double ns_per_page;
+};
+
+// Iterate over @p pages the way a range-based for loop does, and measure the
+// page transitions after the first few pages have warmed up the buffers.
+Transitions MeasureTransitions(BenchmarkPages const& pages, int warmup) {
+  auto iter = pages.begin();
+  for (int i = 0; i != warmup; ++i) {
+    ++iter;
+  }
+  int count = 0;
+  long before = gax::internal::AllocationCount();
+  auto start = std::chrono::steady_clock::now();
+  for (; iter != pages.end(); ++iter) {
+    ++count;
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  long allocations = gax::internal::AllocationCount() - before;
+  return Transitions{
+      static_cast<double>(allocations) / count,
+      static_cast<double>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+              .count()) /
+          count};
+}
+
+TEST(PagesAllocations, PageTransitions) {
+  int const kPages = 10000;
+  BenchmarkPages pages{BenchmarkRetriever(kPages)};
+  auto t = MeasureTransitions(pages, 3);
+  RecordProperty("allocations_per_page",
+                 std::to_string(t.allocations_per_page));
+  RecordProperty("ns_per_page", std::to_string(t.ns_per_page));
+  EXPECT_EQ(t.allocations_per_page, 0);
+}
+
+TEST(PagesAllocations, ArenaPageTransitions) {
+  int const kPages = 10000;
+  gax::PagesOptions options;
+  options.arena_block_size = 16 * 1024;
+  BenchmarkPages pages(BenchmarkRetriever(kPages), 0, options);
+  auto t = MeasureTransitions(pages, 0);
+  RecordProperty("allocations_per_page",
+                 std::to_string(t.allocations_per_page));
+  RecordProperty("ns_per_page", std::to_string(t.ns_per_page));
+  // The messages live on the arena, but the characters of strings that do
+  // not fit the small string optimization are still heap allocated: ten
+  // names and a token per page.
+  EXPECT_LE(t.allocations_per_page, 11);
+}
+
+TEST(PagesAllocations, EndAndTokens) {
+  BenchmarkPages pages{BenchmarkRetriever(2)};
+  auto iter = pages.begin();
+  long before = gax::internal::AllocationCount();
+  bool at_end = iter == pages.end();
+  auto const& token = iter->NextPageToken();
+  EXPECT_EQ(gax::internal::AllocationCount() - before, 0);
+  EXPECT_FALSE(at_end);
+  EXPECT_FALSE(token.empty());
+}
+
+}  // namespace
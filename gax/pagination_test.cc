@@ -14,12 +14,23 @@
 
 #include "gax/pagination.h"
 #include "google/longrunning/operations.pb.h"
+#include "gax/adaptive_page_size.h"
+#include "gax/backoff_policy.h"
+#include "gax/retry_policy.h"
 #include "gax/status.h"
 #include <google/protobuf/util/message_differencer.h>
 #include <gmock/gmock-matchers.h>
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <iterator>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace {
@@ -155,4 +166,483 @@ TEST(Pages, PageCap) {
   EXPECT_EQ(iter->NextPageToken(), "NextPage5");
 }
 
+// Counts calls, so tests can observe fetches made in the background. If given
+// a future, every call but the first waits for it before fetching.
+class CountingPageRetriever {
+ public:
+  explicit CountingPageRetriever(
+      int max_pages,
+      std::shared_future<void> release = std::shared_future<void>())
+      : retriever_(max_pages),
+        release_(std::move(release)),
+        started_(std::make_shared<std::atomic<int>>(0)),
+        calls_(std::make_shared<std::atomic<int>>(0)),
+        threads_(std::make_shared<Threads>()) {}
+  gax::Status operator()(longrunning::ListOperationsResponse* lor) {
+    if (++*started_ > 1 && release_.valid()) {
+      release_.wait();
+    }
+    auto status = retriever_(lor);
+    {
+      std::lock_guard<std::mutex> lk(threads_->mu);
+      threads_->ids.insert(std::this_thread::get_id());
+    }
+    ++*calls_;
+    return status;
+  }
+
+  // The number of calls that have started and completed, respectively.
+  int started() const { return started_->load(); }
+  int calls() const { return calls_->load(); }
+
+  // The number of distinct threads the retriever was called from.
+  std::size_t threads() const {
+    std::lock_guard<std::mutex> lk(threads_->mu);
+    return threads_->ids.size();
+  }
+
+  // Wait until at least @p n calls have completed, or give up after a while.
+  bool WaitForCalls(int n) const { return WaitFor(*calls_, n); }
+
+  // Wait until at least @p n calls have started, or give up after a while.
+  bool WaitForStarted(int n) const { return WaitFor(*started_, n); }
+
+ private:
+  struct Threads {
+    std::mutex mu;
+    std::set<std::thread::id> ids;
+  };
+
+  static bool WaitFor(std::atomic<int> const& count, int n) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (count.load() < n) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+  }
+
+  PageRetriever retriever_;
+  std::shared_future<void> release_;
+  std::shared_ptr<std::atomic<int>> started_;
+  std::shared_ptr<std::atomic<int>> calls_;
+  std::shared_ptr<Threads> threads_;
+};
+
+using PrefetchPages =
+    gax::Pages<longrunning::Operation, longrunning::ListOperationsResponse,
+               OperationsAccessor, CountingPageRetriever>;
+
+gax::PagesOptions PrefetchOptions() {
+  gax::PagesOptions options;
+  options.prefetch = true;
+  return options;
+}
+
+TEST(Pages, Prefetch) {
+  CountingPageRetriever retriever(10);
+  PrefetchPages pages(retriever, 0, PrefetchOptions());
+  int i = 1;
+  for (auto const& p : pages) {
+    std::stringstream ss;
+    ss << "NextPage" << i;
+    EXPECT_EQ(p.NextPageToken(), ss.str());
+    // The next page is fetched while this one is being processed.
+    EXPECT_TRUE(retriever.WaitForCalls(i + 1));
+    i++;
+  }
+  EXPECT_EQ(i, 10);
+  // No page past the last one is requested.
+  EXPECT_EQ(retriever.calls(), 10);
+  // The first page is fetched by begin(), all others by a single worker.
+  EXPECT_EQ(retriever.threads(), 2u);
+}
+
+TEST(Pages, PrefetchPageCap) {
+  CountingPageRetriever retriever(10);
+  PrefetchPages pages(retriever, 5, PrefetchOptions());
+  int i = 1;
+  auto iter = pages.begin();
+  for (; iter != pages.end(); ++iter) {
+    i++;
+  }
+  EXPECT_EQ(i, 5);
+  EXPECT_EQ(iter->NextPageToken(), "NextPage5");
+  // Same pages as the synchronous iterator, and nothing beyond the cap.
+  EXPECT_EQ(retriever.calls(), 5);
+}
+
+TEST(Pages, PrefetchEarlyExit) {
+  CountingPageRetriever retriever(10);
+  {
+    PrefetchPages pages(retriever, 0, PrefetchOptions());
+    auto iter = pages.begin();
+    EXPECT_EQ(iter->NextPageToken(), "NextPage1");
+    // The iterator is destroyed right after it requested the second page,
+    // which may or may not have started by then.
+  }
+  int calls = retriever.calls();
+  EXPECT_GE(calls, 1);
+  EXPECT_LE(calls, 2);
+  // Any fetch that started has completed, and none starts afterwards.
+  EXPECT_EQ(retriever.started(), calls);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(retriever.started(), calls);
+}
+
+TEST(Pages, PrefetchEarlyExitWaitsForFetchInFlight) {
+  std::promise<void> release;
+  CountingPageRetriever retriever(10, release.get_future().share());
+  std::unique_ptr<PrefetchPages> pages(
+      new PrefetchPages(retriever, 0, PrefetchOptions()));
+  std::unique_ptr<PrefetchPages::iterator> iter(
+      new PrefetchPages::iterator(pages->begin()));
+  ASSERT_TRUE(retriever.WaitForStarted(2));
+
+  std::thread destroy([&iter] { iter.reset(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(retriever.calls(), 1);
+  release.set_value();
+  destroy.join();
+  EXPECT_EQ(retriever.calls(), 2);
+  EXPECT_EQ(retriever.started(), 2);
+}
+
+// Returns pages with the given number of operations each, named
+// "op-<page>-<index>".
+class ElementRetriever {
+ public:
+  explicit ElementRetriever(std::vector<int> page_sizes)
+      : page_sizes_(std::move(page_sizes)),
+        page_(0),
+        calls_(std::make_shared<int>(0)) {}
+  gax::Status operator()(longrunning::ListOperationsResponse* lor) {
+    ++*calls_;
+    for (int i = 0; i != page_sizes_[page_]; ++i) {
+      lor->add_operations()->set_name("op-" + std::to_string(page_) + "-" +
+                                      std::to_string(i));
+    }
+    ++page_;
+    if (page_ < static_cast<int>(page_sizes_.size())) {
+      lor->set_next_page_token("NextPage" + std::to_string(page_));
+    }
+    return gax::Status{};
+  }
+
+  int calls() const { return *calls_; }
+
+ private:
+  std::vector<int> page_sizes_;
+  int page_;
+  std::shared_ptr<int> calls_;
+};
+
+using TestElements = gax::PaginatedResult<longrunning::Operation,
+                                          longrunning::ListOperationsResponse,
+                                          OperationsAccessor, ElementRetriever>;
+
+TEST(PaginatedResult, Iteration) {
+  ElementRetriever retriever({2, 0, 1, 0, 2});
+  TestElements elements(retriever);
+  std::vector<std::string> names;
+  for (auto const& e : elements) {
+    names.push_back(e.name());
+  }
+  // Empty pages are skipped and the last page is included.
+  EXPECT_THAT(names, ::testing::ElementsAre("op-0-0", "op-0-1", "op-2-0",
+                                            "op-4-0", "op-4-1"));
+  EXPECT_EQ(retriever.calls(), 5);
+}
+
+TEST(PaginatedResult, Empty) {
+  ElementRetriever retriever({0, 0});
+  TestElements elements(retriever);
+  EXPECT_EQ(elements.begin(), elements.end());
+  EXPECT_EQ(retriever.calls(), 2);
+}
+
+TEST(PaginatedResult, EarlyExit) {
+  ElementRetriever retriever({3, 3, 3});
+  TestElements elements(retriever);
+  int seen = 0;
+  for (auto const& e : elements) {
+    EXPECT_EQ(e.name(), "op-0-" + std::to_string(seen));
+    if (++seen == 3) {
+      break;
+    }
+  }
+  // Stopping at the end of a page does not fetch the next one.
+  EXPECT_EQ(retriever.calls(), 1);
+}
+
+TEST(PaginatedResult, MoveElements) {
+  ElementRetriever retriever({2, 2});
+  TestElements elements(retriever);
+  auto iter = elements.begin();
+  longrunning::Operation op = std::move(*iter);
+  EXPECT_EQ(op.name(), "op-0-0");
+  EXPECT_EQ(iter->name(), "");
+
+  std::vector<longrunning::Operation> rest{
+      std::move_iterator<TestElements::iterator>(++iter),
+      std::move_iterator<TestElements::iterator>(elements.end())};
+  ASSERT_EQ(rest.size(), 3U);
+  EXPECT_EQ(rest[2].name(), "op-1-1");
+}
+
+TEST(PaginatedResult, PageCap) {
+  ElementRetriever retriever({1, 1, 1, 1});
+  TestElements elements(retriever, 2);
+  int seen = 0;
+  for (auto const& e : elements) {
+    EXPECT_EQ(e.name(), "op-" + std::to_string(seen) + "-0");
+    ++seen;
+  }
+  EXPECT_EQ(seen, 2);
+  EXPECT_EQ(retriever.calls(), 2);
+}
+
+gax::PagesOptions ArenaOptions(bool prefetch) {
+  gax::PagesOptions options;
+  options.prefetch = prefetch;
+  options.arena_block_size = 64 * 1024;
+  return options;
+}
+
+TEST(Pages, ArenaPages) {
+  using ElementPages =
+      gax::Pages<longrunning::Operation, longrunning::ListOperationsResponse,
+                 OperationsAccessor, ElementRetriever>;
+  ElementPages pages(ElementRetriever(std::vector<int>(20, 10)), 0,
+                     ArenaOptions(false));
+  auto iter = pages.begin();
+  protobuf::Arena* arena = iter->RawPage().GetArena();
+  ASSERT_NE(arena, nullptr);
+  auto space = arena->SpaceAllocated();
+  for (int i = 0; iter != pages.end(); ++iter, ++i) {
+    EXPECT_EQ(iter->RawPage().operations_size(), 10);
+    EXPECT_EQ(iter->RawPage().operations(9).name(),
+              "op-" + std::to_string(i) + "-9");
+    // The same arena is reset and reused for every page, without growing.
+    EXPECT_EQ(iter->RawPage().GetArena(), arena);
+    EXPECT_EQ(arena->SpaceAllocated(), space);
+  }
+}
+
+TEST(Pages, ArenaPagesPrefetch) {
+  using ElementPages =
+      gax::Pages<longrunning::Operation, longrunning::ListOperationsResponse,
+                 OperationsAccessor, ElementRetriever>;
+  ElementPages pages(ElementRetriever(std::vector<int>(20, 10)), 0,
+                     ArenaOptions(true));
+  std::vector<protobuf::Arena*> arenas;
+  int i = 0;
+  for (auto iter = pages.begin(); iter != pages.end(); ++iter, ++i) {
+    EXPECT_EQ(iter->RawPage().operations(0).name(),
+              "op-" + std::to_string(i) + "-0");
+    arenas.push_back(iter->RawPage().GetArena());
+  }
+  EXPECT_EQ(i, 19);
+  // Two arenas alternate between the current and the prefetched page.
+  ASSERT_GE(arenas.size(), 3U);
+  EXPECT_NE(arenas[0], nullptr);
+  EXPECT_NE(arenas[1], nullptr);
+  EXPECT_NE(arenas[0], arenas[1]);
+  EXPECT_EQ(arenas[0], arenas[2]);
+}
+
+TEST(PaginatedResult, Arena) {
+  TestElements elements(ElementRetriever({2, 2, 2}), 0, ArenaOptions(true));
+  int seen = 0;
+  for (auto& e : elements) {
+    EXPECT_NE(e.GetArena(), nullptr);
+    ++seen;
+  }
+  EXPECT_EQ(seen, 6);
+}
+
+TEST(PageResult, CopyArenaPage) {
+  gax::PagesOptions options = ArenaOptions(false);
+  using ElementPages =
+      gax::Pages<longrunning::Operation, longrunning::ListOperationsResponse,
+                 OperationsAccessor, ElementRetriever>;
+  ElementPages pages(ElementRetriever({3, 1}), 0, options);
+  auto iter = pages.begin();
+  TestedPageResult copy(*iter);
+  // Copies do not share the arena, which is reset on the next page.
+  EXPECT_EQ(copy.RawPage().GetArena(), nullptr);
+  ++iter;
+  EXPECT_EQ(copy.RawPage().operations_size(), 3);
+  EXPECT_EQ(copy.begin()->name(), "op-0-0");
+}
+
+// Fails each page fetch with the given statuses before succeeding. A fetch
+// only advances to the next page when it succeeds.
+class FlakyRetriever {
+ public:
+  FlakyRetriever(std::vector<int> page_sizes,
+                 std::vector<std::vector<gax::Status>> failures)
+      : retriever_(std::move(page_sizes)),
+        failures_(std::move(failures)),
+        page_(0),
+        attempt_(0),
+        calls_(std::make_shared<int>(0)) {}
+  gax::Status operator()(longrunning::ListOperationsResponse* lor) {
+    ++*calls_;
+    if (page_ < static_cast<int>(failures_.size()) &&
+        attempt_ < static_cast<int>(failures_[page_].size())) {
+      // Partial results must not leak into the page.
+      lor->set_next_page_token("garbage");
+      return failures_[page_][attempt_++];
+    }
+    ++page_;
+    attempt_ = 0;
+    return retriever_(lor);
+  }
+
+  int calls() const { return *calls_; }
+
+ private:
+  ElementRetriever retriever_;
+  std::vector<std::vector<gax::Status>> failures_;
+  int page_;
+  int attempt_;
+  std::shared_ptr<int> calls_;
+};
+
+using FlakyElements = gax::PaginatedResult<longrunning::Operation,
+                                           longrunning::ListOperationsResponse,
+                                           OperationsAccessor, FlakyRetriever>;
+
+gax::Status Unavailable() {
+  return gax::Status(gax::StatusCode::kUnavailable, "try again");
+}
+
+gax::PagesOptions RetryOptions(bool prefetch) {
+  gax::PagesOptions options;
+  options.prefetch = prefetch;
+  options.retry_policy = std::make_shared<gax::LimitedErrorCountRetryPolicy<>>(
+      2, std::chrono::milliseconds(10));
+  options.backoff_policy = std::make_shared<gax::ExponentialBackoffPolicy>(
+      std::chrono::microseconds(1), std::chrono::microseconds(10));
+  return options;
+}
+
+std::vector<std::string> Names(FlakyElements const& elements) {
+  std::vector<std::string> names;
+  for (auto const& e : elements) {
+    names.push_back(e.name());
+  }
+  return names;
+}
+
+TEST(PaginatedResult, RetryTransientFailures) {
+  for (bool prefetch : {false, true}) {
+    SCOPED_TRACE(prefetch ? "prefetch" : "no prefetch");
+    FlakyRetriever retriever(
+        {1, 1, 1}, {{Unavailable()}, {}, {Unavailable(), Unavailable()}});
+    FlakyElements elements(retriever, 0, RetryOptions(prefetch));
+    // Each page is retried from its own token, nothing is skipped or repeated.
+    EXPECT_THAT(Names(elements),
+                ::testing::ElementsAre("op-0-0", "op-1-0", "op-2-0"));
+    EXPECT_TRUE(elements.status().IsOk());
+    EXPECT_EQ(retriever.calls(), 6);
+  }
+}
+
+TEST(PaginatedResult, RetryExhausted) {
+  for (bool prefetch : {false, true}) {
+    SCOPED_TRACE(prefetch ? "prefetch" : "no prefetch");
+    FlakyRetriever retriever(
+        {1, 1, 1}, {{}, {Unavailable(), Unavailable(), Unavailable()}});
+    FlakyElements elements(retriever, 0, RetryOptions(prefetch));
+    EXPECT_THAT(Names(elements), ::testing::ElementsAre("op-0-0"));
+    EXPECT_EQ(elements.status(), Unavailable());
+    EXPECT_EQ(retriever.calls(), 4);
+  }
+}
+
+TEST(PaginatedResult, PermanentFailure) {
+  gax::Status denied(gax::StatusCode::kPermissionDenied, "no");
+  FlakyRetriever retriever({1, 1}, {{}, {denied}});
+  FlakyElements elements(retriever, 0, RetryOptions(false));
+  EXPECT_THAT(Names(elements), ::testing::ElementsAre("op-0-0"));
+  EXPECT_EQ(elements.status(), denied);
+  // Permanent errors are not retried.
+  EXPECT_EQ(retriever.calls(), 2);
+}
+
+TEST(Pages, FailureWithoutRetryPolicy) {
+  using FlakyPages =
+      gax::Pages<longrunning::Operation, longrunning::ListOperationsResponse,
+                 OperationsAccessor, FlakyRetriever>;
+  FlakyRetriever retriever({1, 1, 1}, {{}, {}, {Unavailable()}});
+  FlakyPages pages(retriever);
+  int count = 0;
+  for (auto const& p : pages) {
+    EXPECT_EQ(p.RawPage().operations_size(), 1);
+    ++count;
+  }
+  EXPECT_EQ(count, 2);
+  EXPECT_EQ(pages.status(), Unavailable());
+
+  // A new iteration starts with a clean status.
+  FlakyPages fresh(FlakyRetriever({1, 1}, {}));
+  for (auto const& p : fresh) {
+    EXPECT_EQ(p.RawPage().operations_size(), 1);
+  }
+  EXPECT_TRUE(fresh.status().IsOk());
+}
+
+// Returns pages of the size requested through the controller. Each fetch
+// takes a few milliseconds, far longer than the test spends on a page.
+class SizedRetriever {
+ public:
+  SizedRetriever(std::shared_ptr<gax::AdaptivePageSize> page_size,
+                 std::shared_ptr<std::vector<int>> sizes)
+      : page_size_(std::move(page_size)), sizes_(std::move(sizes)) {}
+  gax::Status operator()(longrunning::ListOperationsResponse* lor) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    int size = page_size_->PageSize();
+    sizes_->push_back(size);
+    for (int i = 0; i != size; ++i) {
+      lor->add_operations()->set_name("op");
+    }
+    if (sizes_->size() < 6) {
+      lor->set_next_page_token("more");
+    }
+    return gax::Status();
+  }
+
+ private:
+  std::shared_ptr<gax::AdaptivePageSize> page_size_;
+  std::shared_ptr<std::vector<int>> sizes_;
+};
+
+TEST(PaginatedResult, AdaptivePageSize) {
+  gax::AdaptivePageSizeOptions size_options;
+  size_options.initial_page_size = 2;
+  size_options.max_page_size = 16;
+  size_options.max_page_latency = std::chrono::seconds(10);
+  auto page_size = std::make_shared<gax::AdaptivePageSize>(size_options);
+  auto sizes = std::make_shared<std::vector<int>>();
+
+  gax::PagesOptions options;
+  options.page_size_controller = page_size;
+  gax::PaginatedResult<longrunning::Operation,
+                       longrunning::ListOperationsResponse, OperationsAccessor,
+                       SizedRetriever>
+      elements(SizedRetriever(page_size, sizes), 0, options);
+  int count = 0;
+  for (auto const& e : elements) {
+    EXPECT_EQ(e.name(), "op");
+    ++count;
+  }
+  // Fetching dominates, so pages grow up to the server limit.
+  EXPECT_THAT(*sizes, ::testing::ElementsAre(2, 4, 8, 16, 16, 16));
+  EXPECT_EQ(count, 62);
+}
+
 }  // namespace
@@ -0,0 +1,59 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/retry_budget.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+namespace google {
+namespace gax {
+
+constexpr std::int64_t RetryBudget::kScale;
+
+RetryBudget::RetryBudget(int max_tokens, double token_ratio)
+    : scaled_tokens_(max_tokens * kScale),
+      max_scaled_tokens_(max_tokens * kScale),
+      scaled_deposit_(static_cast<std::int64_t>(token_ratio * kScale)) {}
+
+bool RetryBudget::TryRetry() {
+  std::int64_t current = scaled_tokens_.load(std::memory_order_relaxed);
+  do {
+    if (current < kScale) {
+      return false;
+    }
+  } while (!scaled_tokens_.compare_exchange_weak(current, current - kScale,
+                                                 std::memory_order_relaxed));
+  return true;
+}
+
+void RetryBudget::OnSuccess() {
+  std::int64_t current = scaled_tokens_.load(std::memory_order_relaxed);
+  std::int64_t desired;
+  do {
+    desired = std::min(max_scaled_tokens_, current + scaled_deposit_);
+    if (desired == current) {
+      return;
+    }
+  } while (!scaled_tokens_.compare_exchange_weak(current, desired,
+                                                 std::memory_order_relaxed));
+}
+
+double RetryBudget::Tokens() const {
+  return static_cast<double>(scaled_tokens_.load(std::memory_order_relaxed)) /
+         kScale;
+}
+
+}  // namespace gax
+}  // namespace google
@@ -0,0 +1,84 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GAPIC_GENERATOR_CPP_GAX_RETRY_BUDGET_H_
+#define GAPIC_GENERATOR_CPP_GAX_RETRY_BUDGET_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace google {
+namespace gax {
+
+/**
+ * A token bucket that bounds retry traffic relative to successful traffic.
+ *
+ * Retry policies are cloned for every call, so on their own they cannot limit
+ * the total number of retries a process sends. A RetryBudget is shared by all
+ * the calls that should draw from the same allowance, usually every retry stub
+ * of a client.
+ *
+ * The bucket starts full. Each retry attempt withdraws one token and each
+ * successful call deposits @p token_ratio tokens, up to @p max_tokens. Once the
+ * bucket holds less than one token further retries are refused, so in steady
+ * state retries are limited to roughly `token_ratio` times the rate of
+ * successful calls.
+ *
+ * All member functions are lock-free and safe to call concurrently.
+ *
+ * @par Example
+ * @code
+ * // Allow bursts of 10 retries, and 1 retry for every 10 successes after that.
+ * auto budget = std::make_shared<gax::RetryBudget>(10, 0.1);
+ * auto stub = CreateLibraryServiceStub(creds, budget);
+ * @endcode
+ */
+class RetryBudget {
+ public:
+  RetryBudget(int max_tokens, double token_ratio);
+
+  RetryBudget(RetryBudget const&) = delete;
+  RetryBudget& operator=(RetryBudget const&) = delete;
+
+  /**
+   * Attempt to withdraw a token for a retry.
+   *
+   * @return true if the retry may proceed.
+   */
+  bool TryRetry();
+
+  /**
+   * Deposit tokens for a successful call.
+   */
+  void OnSuccess();
+
+  /**
+   * @brief The number of tokens currently available.
+   */
+  double Tokens() const;
+
+ private:
+  // Tokens are stored as fixed point values to keep all updates on a single
+  // lock-free integer.
+  static constexpr std::int64_t kScale = 1000;
+
+  std::atomic<std::int64_t> scaled_tokens_;
+  std::int64_t const max_scaled_tokens_;
+  std::int64_t const scaled_deposit_;
+};
+
+}  // namespace gax
+}  // namespace google
+
+#endif  // GAPIC_GENERATOR_CPP_GAX_RETRY_BUDGET_H_
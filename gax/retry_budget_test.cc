@@ -0,0 +1,75 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/retry_budget.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace gax {
+namespace {
+
+TEST(RetryBudget, Basic) {
+  RetryBudget tested(2, 0.5);
+  EXPECT_DOUBLE_EQ(tested.Tokens(), 2.0);
+  EXPECT_TRUE(tested.TryRetry());
+  EXPECT_TRUE(tested.TryRetry());
+  EXPECT_FALSE(tested.TryRetry());
+  EXPECT_DOUBLE_EQ(tested.Tokens(), 0.0);
+
+  // Half a token is not enough for a retry.
+  tested.OnSuccess();
+  EXPECT_FALSE(tested.TryRetry());
+  tested.OnSuccess();
+  EXPECT_TRUE(tested.TryRetry());
+  EXPECT_FALSE(tested.TryRetry());
+}
+
+TEST(RetryBudget, SaturatesAtMax) {
+  RetryBudget tested(3, 1.0);
+  for (int i = 0; i < 10; ++i) {
+    tested.OnSuccess();
+  }
+  EXPECT_DOUBLE_EQ(tested.Tokens(), 3.0);
+}
+
+TEST(RetryBudget, Concurrent) {
+  int const kThreads = 8;
+  int const kTokens = 1000;
+  RetryBudget tested(kTokens, 0.0);
+  std::atomic<int> granted(0);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&tested, &granted] {
+      for (int j = 0; j < kTokens; ++j) {
+        if (tested.TryRetry()) {
+          granted++;
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(granted.load(), kTokens);
+  EXPECT_DOUBLE_EQ(tested.Tokens(), 0.0);
+}
+
+}  // namespace
+}  // namespace gax
+}  // namespace google
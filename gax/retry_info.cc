@@ -0,0 +1,49 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/retry_info.h"
+#include "google/rpc/error_details.pb.h"
+#include "google/rpc/status.pb.h"
+#include <algorithm>
+#include <chrono>
+
+namespace google {
+namespace gax {
+
+bool ServerRetryDelay(Status const& status, std::chrono::microseconds* delay) {
+  if (status.error_details().empty()) {
+    return false;
+  }
+  google::rpc::Status details;
+  if (!details.ParseFromString(status.error_details())) {
+    return false;
+  }
+  for (auto const& any : details.details()) {
+    google::rpc::RetryInfo retry_info;
+    if (!any.Is<google::rpc::RetryInfo>() || !any.UnpackTo(&retry_info)) {
+      continue;
+    }
+    auto const& retry_delay = retry_info.retry_delay();
+    *delay = (std::max)(
+        std::chrono::microseconds(0),
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::seconds(retry_delay.seconds()) +
+            std::chrono::nanoseconds(retry_delay.nanos())));
+    return true;
+  }
+  return false;
+}
+
+}  // namespace gax
+}  // namespace google
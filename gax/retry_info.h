@@ -0,0 +1,38 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GAPIC_GENERATOR_CPP_GAX_RETRY_INFO_H_
+#define GAPIC_GENERATOR_CPP_GAX_RETRY_INFO_H_
+
+#include "gax/status.h"
+#include <chrono>
+
+namespace google {
+namespace gax {
+
+/**
+ * Extract the retry delay requested by the server, if any.
+ *
+ * Servers push back on clients by attaching a google.rpc.RetryInfo to the
+ * error details of a failed rpc.
+ *
+ * @return true if @p status carries a RetryInfo, in which case @p delay is set
+ *     to the requested delay.
+ */
+bool ServerRetryDelay(Status const& status, std::chrono::microseconds* delay);
+
+}  // namespace gax
+}  // namespace google
+
+#endif  // GAPIC_GENERATOR_CPP_GAX_RETRY_INFO_H_
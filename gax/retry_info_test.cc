@@ -0,0 +1,75 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/retry_info.h"
+#include "google/rpc/error_details.pb.h"
+#include "google/rpc/status.pb.h"
+#include "gax/status.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+
+namespace google {
+namespace gax {
+
+TEST(ServerRetryDelay, RetryInfo) {
+  google::rpc::RetryInfo retry_info;
+  retry_info.mutable_retry_delay()->set_seconds(2);
+  retry_info.mutable_retry_delay()->set_nanos(500000000);
+  google::rpc::Status details;
+  details.set_code(static_cast<int>(StatusCode::kUnavailable));
+  details.add_details()->PackFrom(google::rpc::Status());
+  details.add_details()->PackFrom(retry_info);
+
+  Status status(StatusCode::kUnavailable, "Unavailable",
+                details.SerializeAsString());
+  std::chrono::microseconds delay;
+  ASSERT_TRUE(ServerRetryDelay(status, &delay));
+  EXPECT_EQ(delay, std::chrono::milliseconds(2500));
+}
+
+TEST(ServerRetryDelay, NoRetryInfo) {
+  std::chrono::microseconds delay(42);
+  EXPECT_FALSE(ServerRetryDelay(
+      Status(StatusCode::kUnavailable, "Unavailable"), &delay));
+
+  google::rpc::Status details;
+  details.add_details()->PackFrom(google::rpc::Status());
+  EXPECT_FALSE(ServerRetryDelay(
+      Status(StatusCode::kUnavailable, "Unavailable",
+             details.SerializeAsString()),
+      &delay));
+
+  EXPECT_FALSE(ServerRetryDelay(
+      Status(StatusCode::kUnavailable, "Unavailable", "not a proto \xff"),
+      &delay));
+  EXPECT_EQ(delay, std::chrono::microseconds(42));
+}
+
+TEST(ServerRetryDelay, GrpcStatus) {
+  google::rpc::RetryInfo retry_info;
+  retry_info.mutable_retry_delay()->set_seconds(1);
+  google::rpc::Status details;
+  details.add_details()->PackFrom(retry_info);
+
+  Status status = GrpcStatusToGaxStatus(
+      grpc::Status(grpc::StatusCode::UNAVAILABLE, "Unavailable",
+                   details.SerializeAsString()));
+  std::chrono::microseconds delay;
+  ASSERT_TRUE(ServerRetryDelay(status, &delay));
+  EXPECT_EQ(delay, std::chrono::seconds(1));
+}
+
+}  // namespace gax
+}  // namespace google
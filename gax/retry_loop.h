@@ -15,17 +15,176 @@
 #ifndef GAPIC_GENERATOR_CPP_GAX_RETRY_LOOP_H_
 #define GAPIC_GENERATOR_CPP_GAX_RETRY_LOOP_H_
 
+#include "grpcpp/alarm.h"
+#include "grpcpp/completion_queue.h"
 #include "gax/backoff_policy.h"
 #include "gax/call_context.h"
+#include "gax/cancellation_token.h"
+#include "gax/completion_queue.h"
 #include "gax/internal/invoke_result.h"
+#include "gax/retry_budget.h"
+#include "gax/retry_info.h"
 #include "gax/retry_policy.h"
 #include "gax/status.h"
+#include <algorithm>
+#include <chrono>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <type_traits>
 
 namespace google {
 namespace gax {
 
+namespace internal {
+
+/**
+ * Record the outcome of an attempt and decide whether to retry.
+ *
+ * The retry budget, if any, is only consulted once the retry policy has
+ * decided the failure is retryable.
+ */
+template <typename RetryPolicyT>
+bool ShouldRetry(gax::Status const& status, RetryPolicyT& retry_policy,
+                 gax::RetryBudget* retry_budget) {
+  if (status.IsOk()) {
+    if (retry_budget) {
+      retry_budget->OnSuccess();
+    }
+    return false;
+  }
+  return retry_policy.OnFailure(status) &&
+         (!retry_budget || retry_budget->TryRetry());
+}
+
+/**
+ * The deadline for the next attempt: the tighter of the caller's deadline, if
+ * any, and the one chosen by the retry policy.
+ */
+template <typename RetryPolicyT>
+std::chrono::system_clock::time_point AttemptDeadline(
+    gax::CallContext const& context, RetryPolicyT const& retry_policy) {
+  return (std::min)(context.Deadline(), retry_policy.OperationDeadline());
+}
+
+/**
+ * Return true if another attempt can still be sent after waiting @p backoff,
+ * that is, if the wait ends before both the caller's deadline and the retry
+ * policy's overall deadline.
+ *
+ * The policy's per-attempt deadline does not matter here: it is computed
+ * afresh for the next attempt, once the backoff is over.
+ */
+template <typename RetryPolicyT>
+bool BackoffFits(gax::CallContext const& context,
+                 RetryPolicyT const& retry_policy,
+                 std::chrono::microseconds backoff) {
+  auto deadline = (std::min)(context.Deadline(), retry_policy.RetryDeadline());
+  return deadline - std::chrono::system_clock::now() > backoff;
+}
+
+/**
+ * The delay before the next attempt: the one requested by the server through
+ * RetryInfo, if any, otherwise the one chosen by the backoff policy.
+ */
+template <typename BackoffPolicyT>
+std::chrono::microseconds NextBackoff(gax::Status const& status,
+                                      BackoffPolicyT& backoff_policy) {
+  // Always consult the policy so its schedule keeps advancing.
+  auto backoff = backoff_policy.OnCompletion();
+  std::chrono::microseconds server_delay;
+  if (gax::ServerRetryDelay(status, &server_delay)) {
+    return server_delay;
+  }
+  return backoff;
+}
+
+/**
+ * Wait out @p backoff, returning early if the call is cancelled.
+ *
+ * @return false if the call was cancelled.
+ */
+inline bool WaitForBackoff(gax::CallContext const& context,
+                           std::chrono::microseconds backoff) {
+  auto const& token = context.CancellationToken();
+  if (token) {
+    return token->WaitFor(backoff);
+  }
+  std::this_thread::sleep_for(backoff);
+  return true;
+}
+
+/**
+ * The status reported when the caller cancels the call during a backoff.
+ */
+inline gax::Status RetryCancelled(gax::Status const& last_status) {
+  return gax::Status(
+      gax::StatusCode::kCancelled,
+      "call cancelled during retry backoff; last error: " +
+          last_status.message());
+}
+
+/**
+ * The status reported when the caller's deadline leaves no room for another
+ * attempt.
+ */
+inline gax::Status RetryDeadlineExceeded(gax::Status const& last_status) {
+  return gax::Status(
+      gax::StatusCode::kDeadlineExceeded,
+      "call deadline leaves no time to retry; last error: " +
+          last_status.message());
+}
+
+/**
+ * The synchronous retry loop shared by both MakeRetryCall() overloads.
+ */
+template <typename RequestT, typename ResponseT, typename FunctorT,
+          typename RetryPolicyT, typename BackoffPolicyT>
+gax::Status RetryLoop(gax::CallContext& context, RequestT const& request,
+                      ResponseT* response, FunctorT& next_stub,
+                      RetryPolicyT& retry_policy,
+                      BackoffPolicyT& backoff_policy,
+                      gax::RetryBudget* retry_budget) {
+  while (true) {
+    // The next layer stub may add metadata, so create a
+    // fresh call context each time through the loop.
+    gax::CallContext context_copy(context);
+    context_copy.SetDeadline(AttemptDeadline(context, retry_policy));
+    gax::Status status = next_stub(context_copy, request, response);
+    if (!ShouldRetry(status, retry_policy, retry_budget)) {
+      return status;
+    }
+
+    auto backoff = NextBackoff(status, backoff_policy);
+    if (!BackoffFits(context, retry_policy, backoff)) {
+      return RetryDeadlineExceeded(status);
+    }
+    if (!WaitForBackoff(context, backoff)) {
+      return RetryCancelled(status);
+    }
+  }
+}
+
+}  // namespace internal
+
+/**
+ * Invoke @p next_stub until it succeeds or the retry policy gives up.
+ *
+ * Each attempt gets the tighter of the deadline set on @p context and the
+ * retry policy's operation deadline. The loop never sleeps past the deadline
+ * set on @p context or the retry policy's RetryDeadline(): if the next backoff
+ * would end after either of them, the loop stops with kDeadlineExceeded.
+ *
+ * If a failed attempt carries a google.rpc.RetryInfo, the delay requested by
+ * the server replaces the backoff policy's delay for that retry.
+ *
+ * Cancelling the cancellation token attached to @p context, if any, cancels
+ * the in-flight attempt and interrupts the backoff wait.
+ *
+ * @param retry_budget if not null, retries are additionally limited by this
+ *     budget, which is usually shared by many calls. Not owned.
+ */
 template <typename RequestT, typename ResponseT, typename FunctorT,
           typename std::enable_if<
               gax::internal::is_invocable<FunctorT, gax::CallContext&,
@@ -34,19 +193,199 @@ template <typename RequestT, typename ResponseT, typename FunctorT,
 gax::Status MakeRetryCall(gax::CallContext& context, RequestT const& request,
                           ResponseT* response, FunctorT&& next_stub,
                           std::unique_ptr<gax::RetryPolicy> retry_policy,
-                          std::unique_ptr<gax::BackoffPolicy> backoff_policy) {
-  while (true) {
-    // The next layer stub may add metadata, so create a
-    // fresh call context each time through the loop.
-    gax::CallContext context_copy(context);
-    context_copy.SetDeadline(retry_policy->OperationDeadline());
-    gax::Status status = next_stub(context_copy, request, response);
-    if (status.IsOk() || !retry_policy->OnFailure(status)) {
-      return status;
+                          std::unique_ptr<gax::BackoffPolicy> backoff_policy,
+                          gax::RetryBudget* retry_budget = nullptr) {
+  return internal::RetryLoop(context, request, response, next_stub,
+                             *retry_policy, *backoff_policy, retry_budget);
+}
+
+/**
+ * Invoke @p next_stub until it succeeds or @p retry_policy gives up, using
+ * policies whose types are known at compile time.
+ *
+ * Behaves like the overload taking `std::unique_ptr`s, but the policies live
+ * on the caller's stack: nothing is cloned or allocated, and the compiler can
+ * resolve the policy calls statically. Since policies are stateful, each call
+ * needs its own copies; copying a policy gives it fresh state.
+ *
+ * @par Example
+ * @code
+ * gax::LimitedErrorCountRetryPolicy<> const retry(3, std::chrono::seconds(1));
+ * gax::ExponentialBackoffPolicy const backoff(std::chrono::milliseconds(10),
+ *                                             std::chrono::seconds(1));
+ * gax::Status status = gax::MakeRetryCall<GetFooRequest, Foo>(
+ *     context, request, &response, invoke_stub, retry, backoff);
+ * @endcode
+ */
+template <typename RequestT, typename ResponseT, typename FunctorT,
+          typename RetryPolicyT, typename BackoffPolicyT,
+          typename std::enable_if<
+              gax::internal::is_invocable<FunctorT, gax::CallContext&,
+                                          RequestT const&, ResponseT*>::value &&
+                  std::is_base_of<gax::RetryPolicy, RetryPolicyT>::value &&
+                  std::is_base_of<gax::BackoffPolicy, BackoffPolicyT>::value,
+              int>::type = 0>
+gax::Status MakeRetryCall(gax::CallContext& context, RequestT const& request,
+                          ResponseT* response, FunctorT&& next_stub,
+                          RetryPolicyT retry_policy,
+                          BackoffPolicyT backoff_policy,
+                          gax::RetryBudget* retry_budget = nullptr) {
+  return internal::RetryLoop(context, request, response, next_stub,
+                             retry_policy, backoff_policy, retry_budget);
+}
+
+namespace internal {
+
+/**
+ * The state of one asynchronous retry loop.
+ *
+ * At any time exactly one of the following holds a reference to the loop: the
+ * completion callback of the in-flight attempt, or the pending backoff timer.
+ * No thread is held while waiting for either.
+ */
+template <typename RequestT, typename ResponseT, typename FunctorT>
+class AsyncRetryLoop : public std::enable_shared_from_this<
+                           AsyncRetryLoop<RequestT, ResponseT, FunctorT>> {
+ public:
+  AsyncRetryLoop(gax::CallContext const& context, RequestT const& request,
+                 ResponseT* response, grpc::CompletionQueue* cq,
+                 FunctorT next_stub,
+                 std::unique_ptr<gax::RetryPolicy> retry_policy,
+                 std::unique_ptr<gax::BackoffPolicy> backoff_policy,
+                 std::function<void(gax::Status)> done,
+                 gax::RetryBudget* retry_budget)
+      : context_(context),
+        request_(request),
+        response_(response),
+        cq_(cq),
+        next_stub_(std::move(next_stub)),
+        retry_policy_(std::move(retry_policy)),
+        backoff_policy_(std::move(backoff_policy)),
+        done_(std::move(done)),
+        retry_budget_(retry_budget) {}
+
+  void StartAttempt() {
+    // The next layer stub may add metadata, and may reference the context
+    // until the attempt completes, so each attempt owns a fresh copy.
+    attempt_context_.reset(new gax::CallContext(context_));
+    attempt_context_->SetDeadline(AttemptDeadline(context_, *retry_policy_));
+    auto self = this->shared_from_this();
+    next_stub_(*attempt_context_, request_, response_, cq_,
+               [self](gax::Status status) { self->OnAttempt(status); });
+  }
+
+ private:
+  class BackoffTimer final : public gax::AsyncOperation {
+   public:
+    explicit BackoffTimer(std::shared_ptr<AsyncRetryLoop> loop)
+        : loop_(std::move(loop)) {}
+
+    void Set(grpc::CompletionQueue* cq, std::chrono::microseconds delay) {
+      // The alarm may fire, and this object be deleted, as soon as it is set.
+      // Holding mu_ delays Notify() until the cancellation is registered.
+      std::lock_guard<std::mutex> lk(mu_);
+      alarm_.Set(cq, std::chrono::system_clock::now() + delay, this);
+      auto const& token = loop_->context_.CancellationToken();
+      if (token) {
+        cancellation_ = token->OnCancel([this] { alarm_.Cancel(); });
+      }
+    }
+
+    void Notify(bool ok) override {
+      { std::lock_guard<std::mutex> lk(mu_); }
+      if (!ok) {
+        loop_->done_(RetryCancelled(loop_->last_status_));
+        return;
+      }
+      loop_->StartAttempt();
+    }
+
+   private:
+    std::shared_ptr<AsyncRetryLoop> loop_;
+    std::mutex mu_;
+    grpc::Alarm alarm_;
+    // Must be unregistered before alarm_ goes away.
+    gax::CancellationToken::Registration cancellation_;
+  };
+
+  void OnAttempt(gax::Status const& status) {
+    if (!ShouldRetry(status, *retry_policy_, retry_budget_)) {
+      done_(status);
+      return;
     }
 
-    std::this_thread::sleep_for(backoff_policy->OnCompletion());
+    auto backoff = NextBackoff(status, *backoff_policy_);
+    if (!BackoffFits(context_, *retry_policy_, backoff)) {
+      done_(RetryDeadlineExceeded(status));
+      return;
+    }
+
+    // Reported if the backoff is cancelled.
+    last_status_ = status;
+    // The completion queue owns the timer once it has been set.
+    auto* timer = new BackoffTimer(this->shared_from_this());
+    timer->Set(cq_, backoff);
   }
+
+  gax::CallContext const context_;
+  RequestT const& request_;
+  ResponseT* response_;
+  grpc::CompletionQueue* cq_;
+  FunctorT next_stub_;
+  std::unique_ptr<gax::RetryPolicy> retry_policy_;
+  std::unique_ptr<gax::BackoffPolicy> backoff_policy_;
+  std::function<void(gax::Status)> done_;
+  gax::RetryBudget* retry_budget_;
+  std::unique_ptr<gax::CallContext> attempt_context_;
+  gax::Status last_status_;
+};
+
+}  // namespace internal
+
+/**
+ * Asynchronous counterpart of MakeRetryCall.
+ *
+ * Starts the first attempt and returns immediately. Attempts are issued via
+ * @p next_stub, and backoff between attempts is implemented with a timer on
+ * @p cq, so waiting out a backoff does not hold any thread. Deadlines are
+ * handled as in MakeRetryCall. @p done is invoked
+ * exactly once, from a thread running @p cq (or from the calling thread if the
+ * next stub completes synchronously), with the status of the final attempt.
+ *
+ * The tags placed on @p cq are AsyncOperations; the queue is expected to be
+ * driven via RunCompletionQueue().
+ *
+ * @par Pre-conditions
+ * @p request and @p response must remain valid until @p done is called.
+ *
+ * @param next_stub a functor with the signature
+ *     `void(gax::CallContext&, RequestT const&, ResponseT*,
+ *           grpc::CompletionQueue*, std::function<void(gax::Status)>)`
+ *     that starts a single asynchronous attempt.
+ * @param retry_budget if not null, retries are additionally limited by this
+ *     budget. Not owned, must outlive the call.
+ */
+template <typename RequestT, typename ResponseT, typename FunctorT,
+          typename std::enable_if<
+              gax::internal::is_invocable<
+                  FunctorT, gax::CallContext&, RequestT const&, ResponseT*,
+                  grpc::CompletionQueue*,
+                  std::function<void(gax::Status)>>::value,
+              int>::type = 0>
+void MakeAsyncRetryCall(gax::CallContext const& context,
+                        RequestT const& request, ResponseT* response,
+                        grpc::CompletionQueue* cq, FunctorT&& next_stub,
+                        std::unique_ptr<gax::RetryPolicy> retry_policy,
+                        std::unique_ptr<gax::BackoffPolicy> backoff_policy,
+                        std::function<void(gax::Status)> done,
+                        gax::RetryBudget* retry_budget = nullptr) {
+  using Loop = internal::AsyncRetryLoop<RequestT, ResponseT,
+                                        typename std::decay<FunctorT>::type>;
+  std::make_shared<Loop>(context, request, response, cq,
+                         std::forward<FunctorT>(next_stub),
+                         std::move(retry_policy), std::move(backoff_policy),
+                         std::move(done), retry_budget)
+      ->StartAttempt();
 }
 
 }  // namespace gax
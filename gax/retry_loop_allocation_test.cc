@@ -0,0 +1,230 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/longrunning/operations.pb.h"
+#include "gax/backoff_policy.h"
+#include "gax/call_context.h"
+#include "gax/internal/allocation_counter.h"
+#include "gax/retry_loop.h"
+#include "gax/retry_policy.h"
+#include "gax/routing_header.h"
+#include "gax/status.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+using namespace ::google;
+
+class NoBackoffPolicy : public gax::BackoffPolicy {
+ public:
+  std::chrono::microseconds OnCompletion() override {
+    return std::chrono::microseconds(0);
+  }
+  std::unique_ptr<gax::BackoffPolicy> clone() const override {
+    return std::unique_ptr<gax::BackoffPolicy>(new NoBackoffPolicy);
+  }
+};
+
+gax::CallContext CustomizedContext() {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  context.AddMetadata("x-goog-request-params", "name=shelves/1/books/2");
+  context.AddGrpcContextPolicy([](grpc::ClientContext*) {});
+  context.SetRetryPolicy(
+      gax::LimitedErrorCountRetryPolicy<>(100, std::chrono::minutes(1)));
+  context.SetBackoffPolicy(NoBackoffPolicy());
+  return context;
+}
+
+// The number of allocations made by one MakeRetryCall() that takes
+// @p failures retries to succeed.
+long AllocationsPerCall(gax::CallContext& context, int failures) {
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  auto retry_policy = context.RetryPolicy();
+  auto backoff_policy = context.BackoffPolicy();
+  int remaining = failures;
+  auto flaky = [&remaining](gax::CallContext&,
+                            longrunning::GetOperationRequest const&,
+                            longrunning::Operation*) {
+    if (remaining-- > 0) {
+      return gax::Status(gax::StatusCode::kUnavailable, "Unavailable");
+    }
+    return gax::Status();
+  };
+
+  long before = gax::internal::AllocationCount();
+  gax::Status status = gax::MakeRetryCall<longrunning::GetOperationRequest,
+                                          longrunning::Operation>(
+      context, req, &resp, flaky, std::move(retry_policy),
+      std::move(backoff_policy));
+  long allocations = gax::internal::AllocationCount() - before;
+  EXPECT_TRUE(status.IsOk());
+  return allocations;
+}
+
+// Makes a call the way a generated client method does: a fresh context with
+// a routing header, and static retry and backoff policies.
+gax::Status RoutedCall(std::string const& name, int failures) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  auto routing_params = gax::RoutingHeaderBuffer();
+  gax::AppendRoutingParam(routing_params.get(), "name", name);
+  context.SetRoutingHeader(std::move(routing_params));
+
+  gax::LimitedErrorCountRetryPolicy<> const retry_policy(
+      100, std::chrono::minutes(1));
+  NoBackoffPolicy const backoff_policy;
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  int remaining = failures;
+  auto flaky = [&remaining](gax::CallContext& context,
+                            longrunning::GetOperationRequest const&,
+                            longrunning::Operation*) {
+    if (!context.RoutingHeader()) {
+      return gax::Status(gax::StatusCode::kInternal, "No header");
+    }
+    if (remaining-- > 0) {
+      return gax::Status(gax::StatusCode::kUnavailable, "Unavailable");
+    }
+    return gax::Status();
+  };
+  return gax::MakeRetryCall<longrunning::GetOperationRequest,
+                            longrunning::Operation>(
+      context, req, &resp, flaky, retry_policy, backoff_policy);
+}
+
+TEST(CallContextAllocations, Copy) {
+  gax::CallContext context = CustomizedContext();
+  long before = gax::internal::AllocationCount();
+  gax::CallContext copy(context);
+  copy.SetDeadline(std::chrono::system_clock::now());
+  EXPECT_EQ(gax::internal::AllocationCount() - before, 0);
+}
+
+TEST(CallContextAllocations, StaticMetadata) {
+  auto metadata = gax::DefaultStaticMetadata();
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  long before = gax::internal::AllocationCount();
+  gax::CallContext context(mi);
+  context.SetStaticMetadata(metadata);
+  gax::CallContext copy(context);
+  EXPECT_EQ(gax::internal::AllocationCount() - before, 0);
+}
+
+TEST(CallContextAllocations, GrpcContextPolicies) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  int counter = 0;
+  int* counter_ptr = &counter;
+  auto policy = [counter_ptr, &mi](grpc::ClientContext*) { ++*counter_ptr; };
+
+  // The design this replaced: a std::vector of std::functions.
+  long before = gax::internal::AllocationCount();
+  {
+    std::vector<GrpcContextPolicyFunc> policies;
+    for (int i = 0; i != 3; ++i) {
+      policies.emplace_back(policy);
+    }
+    std::vector<GrpcContextPolicyFunc> copy(policies);
+  }
+  long vector_allocations = gax::internal::AllocationCount() - before;
+
+  before = gax::internal::AllocationCount();
+  {
+    gax::CallContext context(mi);
+    for (int i = 0; i != 3; ++i) {
+      context.AddGrpcContextPolicy(policy);
+    }
+    gax::CallContext copy(context);
+    copy.AddGrpcContextPolicy(policy);
+  }
+  long context_allocations = gax::internal::AllocationCount() - before;
+
+  EXPECT_GT(vector_allocations, 0);
+  EXPECT_EQ(context_allocations, 0);
+  RecordProperty("std_vector_allocations",
+                 static_cast<int>(vector_allocations));
+  RecordProperty("call_context_allocations",
+                 static_cast<int>(context_allocations));
+}
+
+TEST(RetryLoopAllocations, NoAllocationsPerAttempt) {
+  gax::CallContext context = CustomizedContext();
+  long single_attempt = AllocationsPerCall(context, 0);
+  long many_attempts = AllocationsPerCall(context, 10);
+  EXPECT_EQ(single_attempt, 0);
+  EXPECT_EQ(many_attempts, single_attempt);
+  RecordProperty("allocations_per_call", static_cast<int>(single_attempt));
+  RecordProperty("allocations_per_call_with_10_retries",
+                 static_cast<int>(many_attempts));
+}
+
+TEST(RetryLoopAllocations, StaticPolicies) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  gax::LimitedErrorCountRetryPolicy<> const retry_policy(
+      100, std::chrono::minutes(1));
+  NoBackoffPolicy const backoff_policy;
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  int remaining = 10;
+  auto flaky = [&remaining](gax::CallContext&,
+                            longrunning::GetOperationRequest const&,
+                            longrunning::Operation*) {
+    if (remaining-- > 0) {
+      return gax::Status(gax::StatusCode::kUnavailable, "Unavailable");
+    }
+    return gax::Status();
+  };
+
+  // Neither the policies nor the attempts allocate.
+  long before = gax::internal::AllocationCount();
+  gax::Status status = gax::MakeRetryCall<longrunning::GetOperationRequest,
+                                          longrunning::Operation>(
+      context, req, &resp, flaky, retry_policy, backoff_policy);
+  long allocations = gax::internal::AllocationCount() - before;
+  EXPECT_TRUE(status.IsOk());
+  EXPECT_EQ(allocations, 0);
+}
+
+TEST(RetryLoopAllocations, RoutingHeader) {
+  // Long enough that the encoded header does not fit in the inline storage
+  // of a std::string.
+  std::string const name = "projects/my-project/shelves/1/books/2";
+  // The first call on the thread allocates the thread's header buffer.
+  ASSERT_TRUE(RoutedCall(name, 0).IsOk());
+
+  long before = gax::internal::AllocationCount();
+  gax::Status status = RoutedCall(name, 0);
+  long single_attempt = gax::internal::AllocationCount() - before;
+  EXPECT_TRUE(status.IsOk());
+
+  before = gax::internal::AllocationCount();
+  status = RoutedCall(name, 10);
+  long many_attempts = gax::internal::AllocationCount() - before;
+  EXPECT_TRUE(status.IsOk());
+
+  EXPECT_EQ(single_attempt, 0);
+  EXPECT_EQ(many_attempts, 0);
+}
+
+}  // namespace
@@ -14,12 +14,21 @@
 
 #include "gax/retry_loop.h"
 #include "google/longrunning/operations.pb.h"
+#include "google/rpc/error_details.pb.h"
+#include "google/rpc/status.pb.h"
 #include "gax/backoff_policy.h"
 #include "gax/call_context.h"
+#include "gax/cancellation_token.h"
+#include "gax/completion_queue.h"
 #include "gax/internal/test_clock.h"
+#include "gax/retry_budget.h"
 #include "gax/retry_policy.h"
 #include <gtest/gtest.h>
 #include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
 
 namespace {
 using namespace ::google;
@@ -45,6 +54,25 @@ std::unique_ptr<gax::BackoffPolicy> DummyBackoffFactory(int& delay_count) {
       new DummyBackoffPolicy(delay_count));
 }
 
+class FixedBackoffPolicy : public gax::BackoffPolicy {
+ public:
+  explicit FixedBackoffPolicy(std::chrono::microseconds delay)
+      : delay_(delay) {}
+
+  std::chrono::microseconds OnCompletion() override { return delay_; }
+  std::unique_ptr<gax::BackoffPolicy> clone() const override {
+    return std::unique_ptr<gax::BackoffPolicy>(new FixedBackoffPolicy(delay_));
+  }
+
+ private:
+  std::chrono::microseconds delay_;
+};
+
+std::unique_ptr<gax::BackoffPolicy> FixedBackoffFactory(
+    std::chrono::microseconds delay) {
+  return std::unique_ptr<gax::BackoffPolicy>(new FixedBackoffPolicy(delay));
+}
+
 std::unique_ptr<gax::RetryPolicy> ErrCountRetryFactory(
     int n, std::chrono::system_clock::time_point& now_point) {
   return std::unique_ptr<
@@ -122,4 +150,501 @@ TEST(RetryLoop, OperationDeadline) {
       ErrCountRetryFactory(3, now_point), DummyBackoffFactory(delay_count));
 }
 
+TEST(RetryLoop, CallerDeadline) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  int delay_count = 0;
+  std::chrono::system_clock::time_point now_point;
+  // Tighter than the policy's 2ms, and long gone by the wall clock.
+  context.SetDeadline(now_point + std::chrono::milliseconds(1));
+
+  int attempts = 0;
+  auto check_deadline = [&now_point, &attempts](
+      gax::CallContext& ctx, longrunning::GetOperationRequest const&,
+      longrunning::Operation*) {
+    attempts++;
+    EXPECT_EQ(ctx.Deadline(), now_point + std::chrono::milliseconds(1));
+    return gax::Status(gax::StatusCode::kAborted, "Aborted");
+  };
+
+  gax::Status status = gax::MakeRetryCall<longrunning::GetOperationRequest,
+                                          longrunning::Operation>(
+      context, req, &resp, check_deadline, ErrCountRetryFactory(3, now_point),
+      DummyBackoffFactory(delay_count));
+  EXPECT_EQ(status.code(), gax::StatusCode::kDeadlineExceeded);
+  EXPECT_EQ(attempts, 1);
+}
+
+TEST(RetryLoop, BackoffPastDeadline) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+  context.SetDeadline(std::chrono::system_clock::now() + std::chrono::hours(1));
+
+  int attempts = 0;
+  auto always_fail = [&attempts](gax::CallContext&,
+                                 longrunning::GetOperationRequest const&,
+                                 longrunning::Operation*) {
+    attempts++;
+    return gax::Status(gax::StatusCode::kUnavailable, "Unavailable");
+  };
+
+  // Sleeping for two hours would be pointless, so the loop must not.
+  auto start = std::chrono::steady_clock::now();
+  gax::Status status = gax::MakeRetryCall<longrunning::GetOperationRequest,
+                                          longrunning::Operation>(
+      context, req, &resp, always_fail, ErrCountRetryFactory(3, now_point),
+      FixedBackoffFactory(std::chrono::hours(2)));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::minutes(1));
+  EXPECT_EQ(status.code(), gax::StatusCode::kDeadlineExceeded);
+  EXPECT_NE(status.message().find("Unavailable"), std::string::npos);
+  EXPECT_EQ(attempts, 1);
+
+  // A backoff that ends before the deadline is honored.
+  attempts = 0;
+  gax::Status retried = gax::MakeRetryCall<longrunning::GetOperationRequest,
+                                           longrunning::Operation>(
+      context, req, &resp, always_fail, ErrCountRetryFactory(2, now_point),
+      FixedBackoffFactory(std::chrono::microseconds(1)));
+  EXPECT_EQ(retried, gax::Status(gax::StatusCode::kUnavailable, "Unavailable"));
+  EXPECT_EQ(attempts, 3);
+}
+
+TEST(RetryLoop, BackoffPastPolicyDeadline) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  // No deadline on the context: the policy's is the tighter one.
+  gax::CallContext context(mi);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+
+  int attempts = 0;
+  auto always_fail = [&attempts](gax::CallContext&,
+                                 longrunning::GetOperationRequest const&,
+                                 longrunning::Operation*) {
+    attempts++;
+    return gax::Status(gax::StatusCode::kUnavailable, "Unavailable");
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  gax::Status status = gax::MakeRetryCall<longrunning::GetOperationRequest,
+                                          longrunning::Operation>(
+      context, req, &resp, always_fail,
+      gax::LimitedDurationRetryPolicy<>(std::chrono::minutes(1),
+                                        std::chrono::minutes(1)),
+      FixedBackoffPolicy(std::chrono::hours(1)));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::minutes(1));
+  EXPECT_EQ(status.code(), gax::StatusCode::kDeadlineExceeded);
+  EXPECT_NE(status.message().find("Unavailable"), std::string::npos);
+  EXPECT_EQ(attempts, 1);
+}
+
+TEST(RetryLoop, BackoffLongerThanAttemptTimeout) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+
+  int attempts = 0;
+  auto always_fail = [&attempts](gax::CallContext&,
+                                 longrunning::GetOperationRequest const&,
+                                 longrunning::Operation*) {
+    attempts++;
+    return gax::Status(gax::StatusCode::kUnavailable, "Unavailable");
+  };
+
+  // Each attempt gets 1ms, but the backoff between attempts is longer; that
+  // must not end the call.
+  gax::Status status = gax::MakeRetryCall<longrunning::GetOperationRequest,
+                                          longrunning::Operation>(
+      context, req, &resp, always_fail,
+      gax::LimitedErrorCountRetryPolicy<>(2, std::chrono::milliseconds(1)),
+      FixedBackoffPolicy(std::chrono::milliseconds(20)));
+  EXPECT_EQ(status.code(), gax::StatusCode::kUnavailable);
+  EXPECT_EQ(attempts, 3);
+}
+
+TEST(RetryLoop, ServerRetryInfo) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+  context.SetDeadline(std::chrono::system_clock::now() +
+                      std::chrono::minutes(1));
+
+  google::rpc::RetryInfo retry_info;
+  retry_info.mutable_retry_delay()->set_nanos(1000);
+  google::rpc::Status details;
+  details.add_details()->PackFrom(retry_info);
+  std::string serialized = details.SerializeAsString();
+
+  int attempts = 0;
+  auto push_back = [&attempts, &serialized](
+                       gax::CallContext&,
+                       longrunning::GetOperationRequest const&,
+                       longrunning::Operation*) {
+    attempts++;
+    return gax::Status(gax::StatusCode::kUnavailable, "Unavailable",
+                       serialized);
+  };
+
+  // The server asks for a 1us delay, which overrides the policy's hour and
+  // fits in the deadline.
+  gax::Status status = gax::MakeRetryCall<longrunning::GetOperationRequest,
+                                          longrunning::Operation>(
+      context, req, &resp, push_back, ErrCountRetryFactory(2, now_point),
+      FixedBackoffFactory(std::chrono::hours(1)));
+  EXPECT_EQ(status, gax::Status(gax::StatusCode::kUnavailable, "Unavailable"));
+  EXPECT_EQ(attempts, 3);
+}
+
+TEST(RetryLoop, CancelDuringBackoff) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+  auto token = std::make_shared<gax::CancellationToken>();
+  context.SetCancellationToken(token);
+
+  int attempts = 0;
+  auto always_fail = [&attempts, &token](
+      gax::CallContext& ctx, longrunning::GetOperationRequest const&,
+      longrunning::Operation*) {
+    EXPECT_EQ(ctx.CancellationToken(), token);
+    attempts++;
+    return gax::Status(gax::StatusCode::kUnavailable, "Unavailable");
+  };
+
+  std::thread canceller([token] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    token->Cancel();
+  });
+  auto start = std::chrono::steady_clock::now();
+  gax::Status status = gax::MakeRetryCall<longrunning::GetOperationRequest,
+                                          longrunning::Operation>(
+      context, req, &resp, always_fail, ErrCountRetryFactory(3, now_point),
+      FixedBackoffFactory(std::chrono::hours(1)));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::minutes(1));
+  EXPECT_EQ(status.code(), gax::StatusCode::kCancelled);
+  EXPECT_EQ(attempts, 1);
+  canceller.join();
+}
+
+TEST(RetryLoop, StaticPolicies) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+  gax::LimitedErrorCountRetryPolicy<gax::internal::TestClock> const
+      retry_policy(3, std::chrono::milliseconds(10),
+                   gax::internal::TestClock(now_point));
+  FixedBackoffPolicy const backoff_policy(std::chrono::microseconds(1));
+
+  int attempts = 0;
+  auto always_fail = [&attempts](gax::CallContext&,
+                                 longrunning::GetOperationRequest const&,
+                                 longrunning::Operation*) {
+    attempts++;
+    return gax::Status(gax::StatusCode::kUnavailable, "Unavailable");
+  };
+
+  gax::Status status = gax::MakeRetryCall<longrunning::GetOperationRequest,
+                                          longrunning::Operation>(
+      context, req, &resp, always_fail, retry_policy, backoff_policy);
+  EXPECT_EQ(status, gax::Status(gax::StatusCode::kUnavailable, "Unavailable"));
+  EXPECT_EQ(attempts, 4);
+
+  // Each call starts from a fresh copy of the policies.
+  attempts = 0;
+  gax::Status again = gax::MakeRetryCall<longrunning::GetOperationRequest,
+                                         longrunning::Operation>(
+      context, req, &resp, always_fail, retry_policy, backoff_policy);
+  EXPECT_EQ(again, status);
+  EXPECT_EQ(attempts, 4);
+}
+
+TEST(RetryLoop, RetryBudget) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+  gax::RetryBudget budget(2, 1.0);
+
+  int attempts = 0;
+  auto always_fail = [&attempts](gax::CallContext&,
+                                 longrunning::GetOperationRequest const&,
+                                 longrunning::Operation*) {
+    attempts++;
+    return gax::Status(gax::StatusCode::kUnavailable, "Unavailable");
+  };
+
+  int delay_count = 0;
+  // The retry policy would allow 10 retries, the budget only allows 2.
+  gax::Status status = gax::MakeRetryCall<longrunning::GetOperationRequest,
+                                          longrunning::Operation>(
+      context, req, &resp, always_fail, ErrCountRetryFactory(10, now_point),
+      DummyBackoffFactory(delay_count), &budget);
+  EXPECT_EQ(status, gax::Status(gax::StatusCode::kUnavailable, "Unavailable"));
+  EXPECT_EQ(attempts, 3);
+  EXPECT_EQ(delay_count, 2);
+
+  // With the budget exhausted, calls are not retried at all.
+  attempts = 0;
+  gax::MakeRetryCall<longrunning::GetOperationRequest, longrunning::Operation>(
+      context, req, &resp, always_fail, ErrCountRetryFactory(10, now_point),
+      DummyBackoffFactory(delay_count), &budget);
+  EXPECT_EQ(attempts, 1);
+
+  // Successful calls refill the budget.
+  auto succeed = [](gax::CallContext&, longrunning::GetOperationRequest const&,
+                    longrunning::Operation*) { return gax::Status{}; };
+  gax::MakeRetryCall<longrunning::GetOperationRequest, longrunning::Operation>(
+      context, req, &resp, succeed, ErrCountRetryFactory(10, now_point),
+      DummyBackoffFactory(delay_count), &budget);
+  EXPECT_DOUBLE_EQ(budget.Tokens(), 1.0);
+}
+
+TEST(AsyncRetryLoop, Basic) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+  grpc::CompletionQueue cq;
+  std::thread runner(gax::RunCompletionQueue, &cq);
+
+  int attempts_remaining = 3;
+  auto fail_until = [&attempts_remaining, &context](
+      gax::CallContext& ctx, longrunning::GetOperationRequest const&,
+      longrunning::Operation*, grpc::CompletionQueue*,
+      std::function<void(gax::Status)> done) {
+    // Make sure each retry has a fresh context.
+    EXPECT_NE(&context, &ctx);
+    done(((attempts_remaining--) > 1)
+             ? gax::Status(gax::StatusCode::kAborted, "Aborted")
+             : gax::Status{});
+  };
+
+  int delay_count = 0;
+  std::promise<gax::Status> succeed;
+  gax::MakeAsyncRetryCall<longrunning::GetOperationRequest,
+                          longrunning::Operation>(
+      context, req, &resp, &cq, fail_until,
+      ErrCountRetryFactory(10, now_point), DummyBackoffFactory(delay_count),
+      [&succeed](gax::Status s) { succeed.set_value(s); });
+  EXPECT_EQ(succeed.get_future().get(), gax::Status());
+  EXPECT_EQ(attempts_remaining, 0);
+  EXPECT_EQ(delay_count, 2);
+
+  delay_count = 0;
+  attempts_remaining = 10;
+  std::promise<gax::Status> retry_timeout;
+  gax::MakeAsyncRetryCall<longrunning::GetOperationRequest,
+                          longrunning::Operation>(
+      context, req, &resp, &cq, fail_until, ErrCountRetryFactory(3, now_point),
+      DummyBackoffFactory(delay_count),
+      [&retry_timeout](gax::Status s) { retry_timeout.set_value(s); });
+  EXPECT_EQ(retry_timeout.get_future().get(),
+            gax::Status(gax::StatusCode::kAborted, "Aborted"));
+  EXPECT_EQ(attempts_remaining, 6);
+  EXPECT_EQ(delay_count, 3);
+
+  cq.Shutdown();
+  runner.join();
+}
+
+TEST(AsyncRetryLoop, BackoffPastDeadline) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+  grpc::CompletionQueue cq;
+  context.SetDeadline(std::chrono::system_clock::now() + std::chrono::hours(1));
+
+  int attempts = 0;
+  auto always_fail = [&attempts](gax::CallContext&,
+                                 longrunning::GetOperationRequest const&,
+                                 longrunning::Operation*,
+                                 grpc::CompletionQueue*,
+                                 std::function<void(gax::Status)> done) {
+    attempts++;
+    done(gax::Status(gax::StatusCode::kUnavailable, "Unavailable"));
+  };
+
+  std::promise<gax::Status> result;
+  // No timer is set, so the queue never has to run.
+  gax::MakeAsyncRetryCall<longrunning::GetOperationRequest,
+                          longrunning::Operation>(
+      context, req, &resp, &cq, always_fail, ErrCountRetryFactory(3, now_point),
+      FixedBackoffFactory(std::chrono::hours(2)),
+      [&result](gax::Status s) { result.set_value(s); });
+  EXPECT_EQ(result.get_future().get().code(),
+            gax::StatusCode::kDeadlineExceeded);
+  EXPECT_EQ(attempts, 1);
+
+  cq.Shutdown();
+  gax::RunCompletionQueue(&cq);
+}
+
+TEST(AsyncRetryLoop, BackoffPastPolicyDeadline) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  grpc::CompletionQueue cq;
+
+  int attempts = 0;
+  auto always_fail = [&attempts](gax::CallContext&,
+                                 longrunning::GetOperationRequest const&,
+                                 longrunning::Operation*,
+                                 grpc::CompletionQueue*,
+                                 std::function<void(gax::Status)> done) {
+    attempts++;
+    done(gax::Status(gax::StatusCode::kUnavailable, "Unavailable"));
+  };
+
+  std::promise<gax::Status> result;
+  gax::MakeAsyncRetryCall<longrunning::GetOperationRequest,
+                          longrunning::Operation>(
+      context, req, &resp, &cq, always_fail,
+      std::unique_ptr<gax::RetryPolicy>(new gax::LimitedDurationRetryPolicy<>(
+          std::chrono::minutes(1), std::chrono::minutes(1))),
+      FixedBackoffFactory(std::chrono::hours(1)),
+      [&result](gax::Status s) { result.set_value(s); });
+  EXPECT_EQ(result.get_future().get().code(),
+            gax::StatusCode::kDeadlineExceeded);
+  EXPECT_EQ(attempts, 1);
+
+  cq.Shutdown();
+  gax::RunCompletionQueue(&cq);
+}
+
+TEST(AsyncRetryLoop, BackoffLongerThanAttemptTimeout) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  grpc::CompletionQueue cq;
+  std::thread runner(gax::RunCompletionQueue, &cq);
+
+  int attempts = 0;
+  auto always_fail = [&attempts](gax::CallContext&,
+                                 longrunning::GetOperationRequest const&,
+                                 longrunning::Operation*,
+                                 grpc::CompletionQueue*,
+                                 std::function<void(gax::Status)> done) {
+    attempts++;
+    done(gax::Status(gax::StatusCode::kUnavailable, "Unavailable"));
+  };
+
+  std::promise<gax::Status> result;
+  gax::MakeAsyncRetryCall<longrunning::GetOperationRequest,
+                          longrunning::Operation>(
+      context, req, &resp, &cq, always_fail,
+      std::unique_ptr<gax::RetryPolicy>(new gax::LimitedErrorCountRetryPolicy<>(
+          2, std::chrono::milliseconds(1))),
+      FixedBackoffFactory(std::chrono::milliseconds(20)),
+      [&result](gax::Status s) { result.set_value(s); });
+  EXPECT_EQ(result.get_future().get().code(), gax::StatusCode::kUnavailable);
+  EXPECT_EQ(attempts, 3);
+
+  cq.Shutdown();
+  runner.join();
+}
+
+TEST(AsyncRetryLoop, CancelDuringBackoff) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+  grpc::CompletionQueue cq;
+  std::thread runner(gax::RunCompletionQueue, &cq);
+  auto token = std::make_shared<gax::CancellationToken>();
+  context.SetCancellationToken(token);
+
+  std::promise<void> attempted;
+  auto always_fail = [&attempted](gax::CallContext&,
+                                  longrunning::GetOperationRequest const&,
+                                  longrunning::Operation*,
+                                  grpc::CompletionQueue*,
+                                  std::function<void(gax::Status)> done) {
+    done(gax::Status(gax::StatusCode::kUnavailable, "Unavailable"));
+    attempted.set_value();
+  };
+
+  std::promise<gax::Status> result;
+  gax::MakeAsyncRetryCall<longrunning::GetOperationRequest,
+                          longrunning::Operation>(
+      context, req, &resp, &cq, always_fail, ErrCountRetryFactory(3, now_point),
+      FixedBackoffFactory(std::chrono::hours(1)),
+      [&result](gax::Status s) { result.set_value(s); });
+  attempted.get_future().wait();
+  token->Cancel();
+  gax::Status status = result.get_future().get();
+  EXPECT_EQ(status.code(), gax::StatusCode::kCancelled);
+  // Same diagnostics as the synchronous loop.
+  EXPECT_EQ(status, gax::internal::RetryCancelled(gax::Status(
+                        gax::StatusCode::kUnavailable, "Unavailable")));
+
+  cq.Shutdown();
+  runner.join();
+}
+
+TEST(AsyncRetryLoop, PermanentFailure) {
+  gax::MethodInfo mi{"TestMethod", gax::MethodInfo::RpcType::NORMAL_RPC,
+                     gax::MethodInfo::Idempotency::IDEMPOTENT};
+  gax::CallContext context(mi);
+  longrunning::GetOperationRequest req;
+  longrunning::Operation resp;
+  std::chrono::system_clock::time_point now_point;
+  grpc::CompletionQueue cq;
+
+  int attempts = 0;
+  auto not_found = [&attempts](gax::CallContext&,
+                               longrunning::GetOperationRequest const&,
+                               longrunning::Operation*, grpc::CompletionQueue*,
+                               std::function<void(gax::Status)> done) {
+    attempts++;
+    done(gax::Status(gax::StatusCode::kNotFound, "NotFound"));
+  };
+
+  int delay_count = 0;
+  std::promise<gax::Status> result;
+  // No backoff timer is needed, so the queue never has to run.
+  gax::MakeAsyncRetryCall<longrunning::GetOperationRequest,
+                          longrunning::Operation>(
+      context, req, &resp, &cq, not_found, ErrCountRetryFactory(3, now_point),
+      DummyBackoffFactory(delay_count),
+      [&result](gax::Status s) { result.set_value(s); });
+  EXPECT_EQ(result.get_future().get(),
+            gax::Status(gax::StatusCode::kNotFound, "NotFound"));
+  EXPECT_EQ(attempts, 1);
+  EXPECT_EQ(delay_count, 0);
+
+  cq.Shutdown();
+  gax::RunCompletionQueue(&cq);
+}
+
 }  // namespace
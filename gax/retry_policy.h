@@ -21,6 +21,8 @@
 #include <cstdint>
 #include <memory>
 #include <ratio>
+#include <type_traits>
+#include <utility>
 
 namespace google {
 namespace gax {
@@ -63,15 +65,59 @@ class RetryPolicy {
    * @return the _deadline_ for the next RPC, NOT its maximum _duration_.
    */
   virtual std::chrono::system_clock::time_point OperationDeadline() const = 0;
+
+  /**
+   * The time after which the policy allows no further attempts.
+   *
+   * Unlike OperationDeadline() this bounds the whole call, not one attempt,
+   * so retry loops use it to avoid backing off past the end of the call.
+   *
+   * @return `time_point::max()` if the policy does not limit the duration of
+   * the call, which is the default.
+   */
+  virtual std::chrono::system_clock::time_point RetryDeadline() const {
+    return (std::chrono::system_clock::time_point::max)();
+  }
 };
 
+/**
+ * The clock used by retry policies unless a test injects another one.
+ *
+ * It is a steady clock, so adjustments to the wall clock neither cut retries
+ * short nor stretch them out.
+ */
 class DefaultClock {
  public:
-  std::chrono::system_clock::time_point now() const {
-    return std::chrono::system_clock::now();
+  std::chrono::steady_clock::time_point now() const {
+    return std::chrono::steady_clock::now();
   }
 };
 
+namespace internal {
+
+/**
+ * Convert a deadline measured by a policy clock to the system_clock deadline
+ * that gRPC expects.
+ */
+inline std::chrono::system_clock::time_point ToSystemDeadline(
+    std::chrono::system_clock::time_point deadline) {
+  return deadline;
+}
+
+template <typename Duration>
+std::chrono::system_clock::time_point ToSystemDeadline(
+    std::chrono::time_point<std::chrono::steady_clock, Duration> deadline) {
+  return std::chrono::system_clock::now() +
+         std::chrono::duration_cast<std::chrono::system_clock::duration>(
+             deadline - std::chrono::steady_clock::now());
+}
+
+template <typename Clock>
+using ClockTimePoint =
+    typename std::decay<decltype(std::declval<Clock const&>().now())>::type;
+
+}  // namespace internal
+
 /**
  * Implement a simple "count errors and then stop" retry policy.
  */
@@ -106,7 +152,7 @@ class LimitedErrorCountRetryPolicy : public RetryPolicy {
   }
 
   std::chrono::system_clock::time_point OperationDeadline() const override {
-    return c_.now() + rpc_duration_;
+    return internal::ToSystemDeadline(c_.now() + rpc_duration_);
   }
 
  private:
@@ -151,14 +197,19 @@ class LimitedDurationRetryPolicy : public RetryPolicy {
   }
 
   std::chrono::system_clock::time_point OperationDeadline() const override {
-    return std::min(deadline_, c_.now() + rpc_duration_);
+    return internal::ToSystemDeadline(
+        (std::min)(deadline_, c_.now() + rpc_duration_));
+  }
+
+  std::chrono::system_clock::time_point RetryDeadline() const override {
+    return internal::ToSystemDeadline(deadline_);
   }
 
  private:
   Clock c_;
   std::chrono::milliseconds const rpc_duration_;
   std::chrono::milliseconds const max_duration_;
-  std::chrono::system_clock::time_point const deadline_;
+  internal::ClockTimePoint<Clock> const deadline_;
 };
 
 }  // namespace gax
@@ -97,6 +97,16 @@ TEST(LimitedErrorCountRetryPolicy, OperationDeadline) {
   EXPECT_EQ(tested.OperationDeadline(), clone->OperationDeadline());
 }
 
+TEST(LimitedErrorCountRetryPolicy, SteadyClockDeadline) {
+  // The default clock is monotonic, but deadlines are still reported on the
+  // system clock.
+  gax::LimitedErrorCountRetryPolicy<> tested(3, std::chrono::minutes(1));
+  auto expected = std::chrono::system_clock::now() + std::chrono::minutes(1);
+  auto deadline = tested.OperationDeadline();
+  EXPECT_LT(deadline, expected + std::chrono::seconds(10));
+  EXPECT_GT(deadline, expected - std::chrono::seconds(10));
+}
+
 TEST(LimitedDurationRetryPolicy, Basic) {
   std::chrono::system_clock::time_point now_point;
   gax::LimitedDurationRetryPolicy<gax::internal::TestClock> tested(
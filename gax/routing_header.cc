@@ -0,0 +1,71 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/routing_header.h"
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace google {
+namespace gax {
+
+namespace {
+
+bool IsUnreserved(char c) {
+  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+         (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' ||
+         c == '~';
+}
+
+}  // namespace
+
+void AppendRoutingParam(std::string* header, char const* key,
+                        std::string const& value) {
+  static char const kHexDigits[] = "0123456789ABCDEF";
+  // Reserve for the worst case, where every character is escaped, so the
+  // buffer grows at most once per parameter.
+  header->reserve(header->size() + 2 + std::strlen(key) + 3 * value.size());
+  if (!header->empty()) {
+    header->push_back('&');
+  }
+  header->append(key);
+  header->push_back('=');
+  for (char c : value) {
+    if (IsUnreserved(c)) {
+      header->push_back(c);
+      continue;
+    }
+    auto u = static_cast<unsigned char>(c);
+    header->push_back('%');
+    header->push_back(kHexDigits[u >> 4]);
+    header->push_back(kHexDigits[u & 0xF]);
+  }
+}
+
+std::shared_ptr<std::string> RoutingHeaderBuffer() {
+  static thread_local std::shared_ptr<std::string> buffer;
+  if (!buffer || buffer.use_count() > 1) {
+    buffer = std::make_shared<std::string>();
+  } else {
+    // Only this thread copies `buffer`, so a count of one means every other
+    // holder is gone. Pair with their release of it before reusing the string.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    buffer->clear();
+  }
+  return buffer;
+}
+
+}  // namespace gax
+}  // namespace google
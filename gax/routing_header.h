@@ -0,0 +1,60 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GAPIC_GENERATOR_CPP_GAX_ROUTING_HEADER_H_
+#define GAPIC_GENERATOR_CPP_GAX_ROUTING_HEADER_H_
+
+#include <memory>
+#include <string>
+
+namespace google {
+namespace gax {
+
+/**
+ * The metadata key carrying the request fields used to route a call to the
+ * backend that owns the resource.
+ */
+constexpr char kRoutingHeaderKey[] = "x-goog-request-params";
+
+/**
+ * Append a `key=value` routing parameter to @p header.
+ *
+ * @p value is URL-encoded, and parameters are separated by '&'. Generated
+ * clients call this once per routing field, building the header in a single
+ * buffer.
+ *
+ * @par Example
+ * @code
+ * auto params = gax::RoutingHeaderBuffer();
+ * gax::AppendRoutingParam(params.get(), "name", "shelves/1/books/2");
+ * // *params == "name=shelves%2F1%2Fbooks%2F2"
+ * context.SetRoutingHeader(std::move(params));
+ * @endcode
+ */
+void AppendRoutingParam(std::string* header, char const* key,
+                        std::string const& value);
+
+/**
+ * Return an empty buffer to build the routing header of one call in.
+ *
+ * Each thread keeps one buffer and hands it out again once no CallContext
+ * holds it any more, so a thread making one call after another reuses the
+ * same storage and does not allocate.
+ */
+std::shared_ptr<std::string> RoutingHeaderBuffer();
+
+}  // namespace gax
+}  // namespace google
+
+#endif  // GAPIC_GENERATOR_CPP_GAX_ROUTING_HEADER_H_
@@ -0,0 +1,59 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/routing_header.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+namespace google {
+namespace gax {
+
+TEST(RoutingHeader, AppendRoutingParam) {
+  std::string header;
+  AppendRoutingParam(&header, "name", "bookShelves/1/books/a b");
+  EXPECT_EQ(header, "name=bookShelves%2F1%2Fbooks%2Fa%20b");
+
+  AppendRoutingParam(&header, "book.name", "Az09-._~");
+  EXPECT_EQ(header, "name=bookShelves%2F1%2Fbooks%2Fa%20b&book.name=Az09-._~");
+}
+
+TEST(RoutingHeader, NonAscii) {
+  std::string header;
+  AppendRoutingParam(&header, "k", "\xc3\xa9&=");
+  EXPECT_EQ(header, "k=%C3%A9%26%3D");
+}
+
+TEST(RoutingHeader, BufferReuse) {
+  auto first = RoutingHeaderBuffer();
+  ASSERT_TRUE(first);
+  AppendRoutingParam(first.get(), "name", "shelves/1");
+
+  // A buffer still held elsewhere is not handed out again.
+  auto second = RoutingHeaderBuffer();
+  EXPECT_NE(second.get(), first.get());
+  EXPECT_TRUE(second->empty());
+  EXPECT_EQ(*first, "name=shelves%2F1");
+
+  AppendRoutingParam(second.get(), "name", "shelves/2");
+  std::string const* storage = second.get();
+  first.reset();
+  second.reset();
+  auto third = RoutingHeaderBuffer();
+  EXPECT_EQ(third.get(), storage);
+  EXPECT_TRUE(third->empty());
+}
+
+}  // namespace gax
+}  // namespace google
@@ -0,0 +1,247 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GAPIC_GENERATOR_CPP_GAX_SHARDED_PAGINATION_H_
+#define GAPIC_GENERATOR_CPP_GAX_SHARDED_PAGINATION_H_
+
+#include "gax/status.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace gax {
+
+/**
+ * Tuning knobs for ShardedPaginatedResult.
+ */
+struct ShardedPaginationOptions {
+  /// The maximum number of shards listed at the same time.
+  int max_parallelism = 4;
+  /// The maximum number of elements fetched but not yet consumed. Shards
+  /// stop fetching while the buffer is full. Values below 1 are treated as 1.
+  std::size_t max_buffered_elements = 1024;
+};
+
+/**
+ * Lists several independent paginated sequences concurrently and merges their
+ * elements into a single stream.
+ *
+ * Each shard is typically a PaginatedResult over one filter or key range of a
+ * large collection. Up to `max_parallelism` shards are listed at a time, each
+ * on its own thread; a new shard starts whenever one finishes. Elements are
+ * moved out of the shards' pages into a bounded buffer and yielded in the
+ * order they arrive, so elements from different shards are interleaved.
+ *
+ * The listing starts on the first call to begin(). The elements are yielded
+ * only once, so later calls to begin() return end(). If a shard ends with an
+ * error, the remaining shards are abandoned, the elements already buffered are
+ * still yielded, and status() reports the error. Destroying the object stops
+ * all shards and waits for the page fetches in flight.
+ *
+ * @par Example
+ * @code
+ * std::vector<BooksResult> shards;
+ * for (auto const& shelf : shelves) {
+ *   shards.emplace_back(MakeGetNextPage(shelf));
+ * }
+ * gax::ShardedPaginatedResult<Book, BooksResult> books(std::move(shards));
+ * for (auto& book : books) {
+ *   // Process books from all shelves.
+ * }
+ * if (!books.status().IsOk()) {
+ *   // The listing is incomplete.
+ * }
+ * @endcode
+ *
+ * @tparam ElementType the type of the elements, which must be movable.
+ * @tparam ShardT a range, such as PaginatedResult, whose iterators yield
+ * mutable references to ElementType and that reports failures through a
+ * `gax::Status status() const` member function. Each shard is iterated on a
+ * single thread.
+ */
+template <typename ElementType, typename ShardT>
+class ShardedPaginatedResult {
+ public:
+  class iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = ElementType;
+    using difference_type = std::ptrdiff_t;
+    using pointer = ElementType*;
+    using reference = ElementType&;
+
+    ElementType& operator*() const { return owner_->current_; }
+    ElementType* operator->() const { return &owner_->current_; }
+    iterator& operator++() {
+      if (!owner_->Pop()) {
+        owner_ = nullptr;
+      }
+      return *this;
+    }
+
+    bool operator==(iterator const& rhs) const {
+      return owner_ == rhs.owner_;
+    }
+    bool operator!=(iterator const& rhs) const { return !(*this == rhs); }
+
+   private:
+    friend ShardedPaginatedResult;
+    explicit iterator(ShardedPaginatedResult* owner = nullptr)
+        : owner_(owner) {}
+
+    ShardedPaginatedResult* owner_;
+  };
+
+  explicit ShardedPaginatedResult(
+      std::vector<ShardT> shards,
+      ShardedPaginationOptions options = ShardedPaginationOptions())
+      : shards_(std::move(shards)),
+        options_(std::move(options)),
+        next_shard_(0),
+        running_(0),
+        cancelled_(false) {}
+
+  ShardedPaginatedResult(ShardedPaginatedResult const&) = delete;
+  ShardedPaginatedResult& operator=(ShardedPaginatedResult const&) = delete;
+
+  ~ShardedPaginatedResult() {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      cancelled_ = true;
+    }
+    not_full_.notify_all();
+    for (auto& t : workers_) {
+      t.join();
+    }
+  }
+
+  iterator begin() {
+    if (!workers_.empty()) {
+      return end();
+    }
+    Start();
+    return Pop() ? iterator(this) : iterator();
+  }
+  iterator end() { return iterator(); }
+
+  /**
+   * OK unless a shard failed, in which case the listing is incomplete.
+   */
+  Status status() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return status_;
+  }
+
+ private:
+  void Start() {
+    auto workers = (std::min)(static_cast<std::size_t>(
+                                  (std::max)(options_.max_parallelism, 1)),
+                              shards_.size());
+    running_ = static_cast<int>(workers);
+    for (std::size_t i = 0; i != workers; ++i) {
+      workers_.emplace_back([this] { Work(); });
+    }
+  }
+
+  // Runs on each worker thread: list shards until none are left.
+  void Work() {
+    while (true) {
+      ShardT* shard;
+      {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (cancelled_ || next_shard_ == shards_.size()) {
+          break;
+        }
+        shard = &shards_[next_shard_++];
+      }
+      if (!ListShard(*shard)) {
+        break;
+      }
+    }
+    std::lock_guard<std::mutex> lk(mu_);
+    --running_;
+    not_empty_.notify_all();
+  }
+
+  // Move the shard's elements into the buffer. Returns false if the listing
+  // was cancelled or the shard failed.
+  bool ListShard(ShardT& shard) {
+    for (auto& element : shard) {
+      std::unique_lock<std::mutex> lk(mu_);
+      not_full_.wait(lk, [this] {
+        return cancelled_ ||
+               buffer_.size() < (std::max)(options_.max_buffered_elements,
+                                           std::size_t{1});
+      });
+      if (cancelled_) {
+        return false;
+      }
+      buffer_.push_back(std::move(element));
+      not_empty_.notify_one();
+    }
+    Status status = shard.status();
+    if (status.IsOk()) {
+      return true;
+    }
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      if (status_.IsOk()) {
+        status_ = std::move(status);
+      }
+      cancelled_ = true;
+    }
+    not_full_.notify_all();
+    return false;
+  }
+
+  // Wait for the next element and make it current. Returns false once every
+  // shard is done and the buffer is drained.
+  bool Pop() {
+    std::unique_lock<std::mutex> lk(mu_);
+    not_empty_.wait(lk, [this] { return !buffer_.empty() || running_ == 0; });
+    if (buffer_.empty()) {
+      return false;
+    }
+    current_ = std::move(buffer_.front());
+    buffer_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  std::vector<ShardT> shards_;
+  ShardedPaginationOptions const options_;
+  std::vector<std::thread> workers_;
+
+  mutable std::mutex mu_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::deque<ElementType> buffer_;
+  std::size_t next_shard_;
+  int running_;
+  bool cancelled_;
+  Status status_;
+  // Only accessed by the consuming thread.
+  ElementType current_;
+};
+
+}  // namespace gax
+}  // namespace google
+
+#endif  // GAPIC_GENERATOR_CPP_GAX_SHARDED_PAGINATION_H_
@@ -0,0 +1,208 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gax/sharded_pagination.h"
+#include "google/longrunning/operations.pb.h"
+#include "gax/pagination.h"
+#include "gax/status.h"
+#include <gmock/gmock-matchers.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace ::google;
+
+class OperationsAccessor {
+ public:
+  protobuf::RepeatedPtrField<longrunning::Operation>* operator()(
+      longrunning::ListOperationsResponse& lor) const {
+    return lor.mutable_operations();
+  }
+};
+
+struct ShardStats {
+  std::atomic<int> fetches{0};
+  std::atomic<int> active{0};
+  std::atomic<int> peak{0};
+};
+
+// Returns `pages` pages of `page_size` operations named
+// "<shard>-<page>-<index>", optionally failing the last page.
+class ShardRetriever {
+ public:
+  ShardRetriever(std::string shard, int pages, int page_size,
+                 std::shared_ptr<ShardStats> stats,
+                 gax::Status last = gax::Status())
+      : shard_(std::move(shard)),
+        pages_(pages),
+        page_size_(page_size),
+        page_(0),
+        stats_(std::move(stats)),
+        last_(std::move(last)) {}
+
+  gax::Status operator()(longrunning::ListOperationsResponse* lor) {
+    int active = ++stats_->active;
+    int peak = stats_->peak.load();
+    while (active > peak && !stats_->peak.compare_exchange_weak(peak, active)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ++stats_->fetches;
+    --stats_->active;
+    if (page_ == pages_ - 1 && !last_.IsOk()) {
+      return last_;
+    }
+    for (int i = 0; i != page_size_; ++i) {
+      lor->add_operations()->set_name(shard_ + "-" + std::to_string(page_) +
+                                      "-" + std::to_string(i));
+    }
+    if (++page_ < pages_) {
+      lor->set_next_page_token("page" + std::to_string(page_));
+    }
+    return gax::Status();
+  }
+
+ private:
+  std::string shard_;
+  int pages_;
+  int page_size_;
+  int page_;
+  std::shared_ptr<ShardStats> stats_;
+  gax::Status last_;
+};
+
+using Shard = gax::PaginatedResult<longrunning::Operation,
+                                   longrunning::ListOperationsResponse,
+                                   OperationsAccessor, ShardRetriever>;
+using Sharded = gax::ShardedPaginatedResult<longrunning::Operation, Shard>;
+
+gax::ShardedPaginationOptions Options(int parallelism, std::size_t buffered) {
+  gax::ShardedPaginationOptions options;
+  options.max_parallelism = parallelism;
+  options.max_buffered_elements = buffered;
+  return options;
+}
+
+TEST(ShardedPaginatedResult, MergesAllShards) {
+  auto stats = std::make_shared<ShardStats>();
+  std::vector<Shard> shards;
+  std::vector<std::string> expected;
+  for (int s = 0; s != 5; ++s) {
+    auto name = "s" + std::to_string(s);
+    shards.emplace_back(ShardRetriever(name, 3, 2, stats));
+    for (int p = 0; p != 3; ++p) {
+      for (int i = 0; i != 2; ++i) {
+        expected.push_back(name + "-" + std::to_string(p) + "-" +
+                           std::to_string(i));
+      }
+    }
+  }
+  Sharded sharded(std::move(shards), Options(2, 3));
+  std::vector<std::string> names;
+  for (auto& op : sharded) {
+    names.push_back(std::move(*op.mutable_name()));
+  }
+  EXPECT_TRUE(sharded.status().IsOk());
+  EXPECT_THAT(names, ::testing::UnorderedElementsAreArray(expected));
+  EXPECT_EQ(stats->fetches.load(), 15);
+  EXPECT_LE(stats->peak.load(), 2);
+}
+
+TEST(ShardedPaginatedResult, PreservesOrderWithinShard) {
+  auto stats = std::make_shared<ShardStats>();
+  std::vector<Shard> shards;
+  shards.emplace_back(ShardRetriever("a", 4, 3, stats));
+  shards.emplace_back(ShardRetriever("b", 4, 3, stats));
+  Sharded sharded(std::move(shards), Options(2, 1));
+  std::vector<std::string> a;
+  for (auto const& op : sharded) {
+    if (op.name()[0] == 'a') {
+      a.push_back(op.name());
+    }
+  }
+  ASSERT_EQ(a.size(), 12U);
+  EXPECT_TRUE(std::is_sorted(a.begin(), a.end()));
+}
+
+TEST(ShardedPaginatedResult, Empty) {
+  Sharded none(std::vector<Shard>{});
+  EXPECT_EQ(none.begin(), none.end());
+  EXPECT_TRUE(none.status().IsOk());
+}
+
+TEST(ShardedPaginatedResult, NoBufferedElements) {
+  auto stats = std::make_shared<ShardStats>();
+  std::vector<Shard> shards;
+  shards.emplace_back(ShardRetriever("a", 2, 2, stats));
+  shards.emplace_back(ShardRetriever("b", 2, 2, stats));
+  // A zero-sized buffer holds one element rather than stalling every shard.
+  Sharded sharded(std::move(shards), Options(0, 0));
+  EXPECT_EQ(std::distance(sharded.begin(), sharded.end()), 8);
+  EXPECT_TRUE(sharded.status().IsOk());
+}
+
+TEST(ShardedPaginatedResult, SecondBegin) {
+  auto stats = std::make_shared<ShardStats>();
+  std::vector<Shard> shards;
+  shards.emplace_back(ShardRetriever("a", 2, 2, stats));
+  Sharded sharded(std::move(shards));
+  auto it = sharded.begin();
+  ASSERT_NE(it, sharded.end());
+  EXPECT_EQ(sharded.begin(), sharded.end());
+  // The first iterator is unaffected.
+  EXPECT_EQ(std::distance(it, sharded.end()), 4);
+  EXPECT_EQ(stats->fetches.load(), 2);
+}
+
+TEST(ShardedPaginatedResult, BoundedBuffer) {
+  auto stats = std::make_shared<ShardStats>();
+  std::vector<Shard> shards;
+  for (int s = 0; s != 4; ++s) {
+    shards.emplace_back(ShardRetriever(std::to_string(s), 1000, 10, stats));
+  }
+  {
+    Sharded sharded(std::move(shards), Options(4, 20));
+    auto it = sharded.begin();
+    ASSERT_NE(it, sharded.end());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    // Each shard stops after filling the buffer: at most one page in flight
+    // per shard beyond the buffered elements.
+    EXPECT_LE(stats->fetches.load(), 4 * 2 + 20 / 10 + 1);
+  }
+  // Destroying the listing stops all shards promptly.
+  EXPECT_LT(stats->fetches.load(), 4 * 1000);
+}
+
+TEST(ShardedPaginatedResult, ShardFailure) {
+  auto stats = std::make_shared<ShardStats>();
+  gax::Status denied(gax::StatusCode::kPermissionDenied, "no");
+  std::vector<Shard> shards;
+  shards.emplace_back(ShardRetriever("bad", 2, 1, stats, denied));
+  Sharded sharded(std::move(shards), Options(1, 10));
+  std::vector<std::string> names;
+  for (auto const& op : sharded) {
+    names.push_back(op.name());
+  }
+  EXPECT_THAT(names, ::testing::ElementsAre("bad-0-0"));
+  EXPECT_EQ(sharded.status(), denied);
+}
+
+}  // namespace
@@ -70,7 +70,8 @@ std::ostream& operator<<(std::ostream& os, Status const& rhs) {
 }
 
 Status GrpcStatusToGaxStatus(grpc::Status s) {
-  return Status(static_cast<StatusCode>(s.error_code()), s.error_message());
+  return Status(static_cast<StatusCode>(s.error_code()), s.error_message(),
+                s.error_details());
 }
 
 }  // namespace gax
@@ -18,6 +18,7 @@
 #include "grpcpp/impl/codegen/status.h"
 #include <ostream>
 #include <string>
+#include <utility>
 
 namespace google {
 namespace gax {
@@ -57,11 +58,25 @@ enum class StatusCode {
  */
 class Status {
  public:
-  Status() : code_(StatusCode::kOk) {}
-  Status(StatusCode code, std::string msg)
-      : code_(code), msg_(std::move(msg)) {}
-  Status(Status const& rhs) : Status(rhs.code_, rhs.msg_) {}
-  Status(Status&& rhs) : Status(rhs.code_, std::move(rhs.msg_)) {}
+  Status() noexcept : code_(StatusCode::kOk) {}
+
+  /**
+   * An OK status never carries a message or error details; they are dropped
+   * if given, so success statuses never own string storage.
+   */
+  Status(StatusCode code, std::string msg,
+         std::string error_details = std::string())
+      : code_(code) {
+    if (code_ != StatusCode::kOk) {
+      msg_ = std::move(msg);
+      error_details_ = std::move(error_details);
+    }
+  }
+
+  Status(Status const& rhs) = default;
+  Status(Status&& rhs) noexcept = default;
+  Status& operator=(Status const& rhs) = default;
+  Status& operator=(Status&& rhs) noexcept = default;
 
   inline bool IsOk() const { return code_ == StatusCode::kOk; }
   inline bool IsTransientFailure() const {
@@ -77,14 +92,21 @@ class Status {
 
   inline std::string const& message() const { return msg_; }
 
+  /**
+   * The serialized google.rpc.Status sent by the server with the error, if
+   * any. It carries structured error details such as google.rpc.RetryInfo.
+   */
+  inline std::string const& error_details() const { return error_details_; }
+
   bool operator==(Status const& rhs) const {
     return code_ == rhs.code_ && msg_ == rhs.msg_;
   }
   bool operator!=(Status const& rhs) const { return !(*this == rhs); }
 
  private:
-  StatusCode const code_;
-  std::string const msg_;
+  StatusCode code_;
+  std::string msg_;
+  std::string error_details_;
 };
 
 std::string StatusCodeToString(StatusCode code);
@@ -19,10 +19,18 @@
 #include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
 namespace google {
 namespace gax {
 
+/**
+ * Tag type selecting the in-place constructor of StatusOr.
+ */
+struct InPlace {};
+constexpr InPlace kInPlace{};
+
 /**
  * Holds a value or a `Status` indicating why there is no value.
  *
@@ -117,7 +125,23 @@ class StatusOr final {
    */
   StatusOr(T const& rhs) : status_() { new (&value_) T(rhs); }
 
-  StatusOr(T&& rhs) : status_() { new (&value_) T(std::move(rhs)); }
+  StatusOr(T&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value)
+      : status_() {
+    new (&value_) T(std::move(rhs));
+  }
+
+  /**
+   * Creates a new `StatusOr<T>` holding a value constructed from @p args.
+   *
+   * @par Example
+   * @code
+   * StatusOr<std::string> s(gax::kInPlace, 3, 'x');  // "xxx"
+   * @endcode
+   */
+  template <typename... Args>
+  explicit StatusOr(InPlace, Args&&... args) : status_() {
+    new (&value_) T(std::forward<Args>(args)...);
+  }
 
   StatusOr(StatusOr const& rhs) : status_(rhs.status_) {
     if (ok()) {
@@ -125,12 +149,62 @@ class StatusOr final {
     }
   }
 
-  StatusOr(StatusOr&& rhs) : status_(std::move(rhs.status_)) {
+  StatusOr(StatusOr&& rhs) noexcept(
+      std::is_nothrow_move_constructible<T>::value)
+      : status_(std::move(rhs.status_)) {
     if (ok()) {
       new (&value_) T(std::move(rhs.value_));
     }
   }
 
+  StatusOr& operator=(StatusOr const& rhs) {
+    if (this == &rhs) {
+      return *this;
+    }
+    if (rhs.ok()) {
+      AssignValue(rhs.value_);
+      status_ = Status();
+      return *this;
+    }
+    // Copy the status first, so a failed copy leaves *this unchanged.
+    Status status(rhs.status_);
+    ResetValue();
+    status_ = std::move(status);
+    return *this;
+  }
+
+  StatusOr& operator=(StatusOr&& rhs) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      std::is_nothrow_move_assignable<T>::value) {
+    if (this == &rhs) {
+      return *this;
+    }
+    if (rhs.ok()) {
+      AssignValue(std::move(rhs.value_));
+    } else {
+      ResetValue();
+    }
+    status_ = std::move(rhs.status_);
+    return *this;
+  }
+
+  /**
+   * Replaces the contents with a value constructed from @p args.
+   *
+   * Any previous value is destroyed first. If the constructor of `T` throws,
+   * the object is left holding an error.
+   *
+   * @return a reference to the new value.
+   */
+  template <typename... Args>
+  T& emplace(Args&&... args) {
+    ResetValue();
+    status_ = Status(StatusCode::kUnknown, std::string());
+    new (&value_) T(std::forward<Args>(args)...);
+    status_ = Status();
+    return value_;
+  }
+
   ~StatusOr() {
     if (ok()) {
       value_.~T();
@@ -198,6 +272,23 @@ class StatusOr final {
   }
 
  private:
+  // Set the value, leaving status_ to the caller.
+  template <typename U>
+  void AssignValue(U&& v) {
+    if (ok()) {
+      value_ = std::forward<U>(v);
+    } else {
+      new (&value_) T(std::forward<U>(v));
+    }
+  }
+
+  // Destroy the value, if any, leaving status_ to the caller.
+  void ResetValue() {
+    if (ok()) {
+      value_.~T();
+    }
+  }
+
   void check_value() const {
     if (!ok()) {
       std::cerr << status_ << std::endl;
@@ -205,7 +296,7 @@ class StatusOr final {
     }
   }
 
-  Status const status_;
+  Status status_;
   union {
     T value_;
   };
@@ -19,6 +19,8 @@
 #include <memory>
 #include <string>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace {
 
@@ -30,6 +32,8 @@ class Observable {
   static int value_constructor;
   static int copy_constructor;
   static int move_constructor;
+  static int copy_assignment;
+  static int move_assignment;
   static int destructor;
 
   static void reset_counters() {
@@ -37,6 +41,8 @@ class Observable {
     value_constructor = 0;
     copy_constructor = 0;
     move_constructor = 0;
+    copy_assignment = 0;
+    move_assignment = 0;
     destructor = 0;
   }
   Observable() { ++default_constructor; }
@@ -44,10 +50,21 @@ class Observable {
     ++value_constructor;
   }
   Observable(Observable const& rhs) : str_(rhs.str_) { ++copy_constructor; }
-  Observable(Observable&& rhs) : str_(std::move(rhs.str_)) {
+  Observable(Observable&& rhs) noexcept : str_(std::move(rhs.str_)) {
     rhs.str_ = "moved-out";
     ++move_constructor;
   }
+  Observable& operator=(Observable const& rhs) {
+    str_ = rhs.str_;
+    ++copy_assignment;
+    return *this;
+  }
+  Observable& operator=(Observable&& rhs) noexcept {
+    str_ = std::move(rhs.str_);
+    rhs.str_ = "moved-out";
+    ++move_assignment;
+    return *this;
+  }
   ~Observable() { ++destructor; }
 
   bool operator==(Observable const& rhs) const { return str_ == rhs.str_; }
@@ -64,11 +81,29 @@ int Observable::default_constructor;
 int Observable::value_constructor;
 int Observable::copy_constructor;
 int Observable::move_constructor;
+int Observable::copy_assignment;
+int Observable::move_assignment;
 int Observable::destructor;
 
 static_assert(!std::is_default_constructible<gax::StatusOr<int>>::value,
               "Default constructed StatusOr is unhelpful.");
 
+static_assert(
+    std::is_nothrow_move_constructible<gax::StatusOr<Observable>>::value,
+    "StatusOr<T> must be nothrow movable when T is.");
+static_assert(
+    std::is_nothrow_move_assignable<gax::StatusOr<Observable>>::value,
+    "StatusOr<T> must be nothrow move-assignable when T is.");
+
+struct ThrowingMove {
+  ThrowingMove() = default;
+  ThrowingMove(ThrowingMove const&) = default;
+  ThrowingMove(ThrowingMove&&) noexcept(false) {}
+};
+static_assert(
+    !std::is_nothrow_move_constructible<gax::StatusOr<ThrowingMove>>::value,
+    "StatusOr<T> must not claim a nothrow move when T does not have one.");
+
 // Although production use is not going to use simple types,
 // testing StatusOr<int> is useful for very basic tests.
 TEST(StatusOr, ConstructFromStatus) {
@@ -241,4 +276,100 @@ TEST(StatusOrObservableTest, MoveValue) {
   EXPECT_EQ("moved-out", tested->str());
 }
 
+TEST(StatusOr, CopyAssign) {
+  gax::Status error(gax::StatusCode::kUnknown, "Because");
+  gax::StatusOr<Observable> value(Observable("value"));
+  gax::StatusOr<Observable> other(Observable("other"));
+  gax::StatusOr<Observable> failed(error);
+
+  // value <- value
+  gax::StatusOr<Observable> tested(Observable("tested"));
+  Observable::reset_counters();
+  tested = value;
+  EXPECT_EQ(Observable::copy_assignment, 1);
+  EXPECT_EQ("value", tested->str());
+
+  // value <- error
+  Observable::reset_counters();
+  tested = failed;
+  EXPECT_EQ(Observable::destructor, 1);
+  EXPECT_FALSE(tested.ok());
+  EXPECT_EQ(tested.status(), error);
+
+  // error <- error
+  tested = failed;
+  EXPECT_EQ(tested.status(), error);
+
+  // error <- value
+  Observable::reset_counters();
+  tested = other;
+  EXPECT_EQ(Observable::copy_constructor, 1);
+  EXPECT_TRUE(tested.ok());
+  EXPECT_EQ("other", tested->str());
+  EXPECT_EQ("other", other->str());
+}
+
+TEST(StatusOr, MoveAssign) {
+  gax::Status error(gax::StatusCode::kUnknown, "Because");
+
+  gax::StatusOr<Observable> tested(Observable("tested"));
+  Observable::reset_counters();
+  tested = gax::StatusOr<Observable>(Observable("value"));
+  EXPECT_EQ(Observable::copy_assignment, 0);
+  EXPECT_EQ(Observable::move_assignment, 1);
+  EXPECT_EQ("value", tested->str());
+
+  tested = gax::StatusOr<Observable>(error);
+  EXPECT_FALSE(tested.ok());
+  EXPECT_EQ(tested.status(), error);
+
+  Observable::reset_counters();
+  gax::StatusOr<Observable> other(Observable("other"));
+  tested = std::move(other);
+  EXPECT_EQ(Observable::copy_constructor, 0);
+  EXPECT_EQ(Observable::move_constructor, 2);
+  EXPECT_EQ("other", tested->str());
+}
+
+TEST(StatusOr, InPlace) {
+  Observable::reset_counters();
+  gax::StatusOr<Observable> tested(gax::kInPlace, "in place");
+  EXPECT_EQ(Observable::value_constructor, 1);
+  EXPECT_EQ(Observable::move_constructor, 0);
+  EXPECT_EQ("in place", tested->str());
+
+  gax::StatusOr<std::string> s(gax::kInPlace, 3, 'x');
+  EXPECT_EQ("xxx", *s);
+}
+
+TEST(StatusOr, Emplace) {
+  gax::StatusOr<Observable> tested(
+      gax::Status(gax::StatusCode::kUnknown, "Because"));
+  Observable::reset_counters();
+  Observable& value = tested.emplace("first");
+  EXPECT_TRUE(tested.ok());
+  EXPECT_EQ(&value, &*tested);
+  EXPECT_EQ("first", tested->str());
+
+  tested.emplace("second");
+  EXPECT_EQ("second", tested->str());
+  EXPECT_EQ(Observable::value_constructor, 2);
+  EXPECT_EQ(Observable::destructor, 1);
+  EXPECT_EQ(Observable::move_constructor, 0);
+}
+
+TEST(StatusOr, VectorReallocationMoves) {
+  std::vector<gax::StatusOr<Observable>> results;
+  results.emplace_back(gax::Status(gax::StatusCode::kUnknown, "Because"));
+  for (int i = 0; i != 10; ++i) {
+    results.emplace_back(gax::kInPlace, std::to_string(i));
+  }
+  Observable::reset_counters();
+  results.reserve(results.capacity() + 1);
+  EXPECT_EQ(Observable::copy_constructor, 0);
+  EXPECT_EQ(Observable::move_constructor, 10);
+  EXPECT_FALSE(results[0].ok());
+  EXPECT_EQ("9", results[10]->str());
+}
+
 }  // namespace
@@ -16,11 +16,19 @@
 #include <gtest/gtest.h>
 #include <sstream>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace {
 
 using namespace ::google;
 
+static_assert(std::is_nothrow_move_constructible<gax::Status>::value,
+              "Status must not copy on container reallocation.");
+static_assert(std::is_nothrow_move_assignable<gax::Status>::value,
+              "Status must be cheaply move-assignable.");
+
 TEST(Status, Basic) {
   {
     gax::Status s;  // sanity check for default construction
@@ -221,8 +229,10 @@ TEST(Status, Equality) {
   gax::Status ok3(gax::StatusCode::kOk, "");
   EXPECT_EQ(ok1, ok3);
 
+  // OK statuses do not keep a message.
   gax::Status ok4(gax::StatusCode::kOk, "Because");
-  EXPECT_NE(ok1, ok4);
+  EXPECT_EQ(ok1, ok4);
+  EXPECT_EQ(ok4.message(), "");
 
   gax::Status cancelled1(gax::StatusCode::kCancelled, "");
   EXPECT_NE(ok1, cancelled1);
@@ -241,4 +251,48 @@ TEST(Status, CopyCtor) {
   EXPECT_EQ(cancelled1, cancelled2);
 }
 
+TEST(Status, ErrorDetails) {
+  gax::Status plain(gax::StatusCode::kUnavailable, "Unavailable");
+  EXPECT_EQ(plain.error_details(), "");
+
+  gax::Status detailed(gax::StatusCode::kUnavailable, "Unavailable", "details");
+  gax::Status copy(detailed);
+  EXPECT_EQ(copy.error_details(), "details");
+  // The details do not take part in comparisons.
+  EXPECT_EQ(plain, detailed);
+
+  gax::Status converted = gax::GrpcStatusToGaxStatus(
+      grpc::Status(grpc::StatusCode::UNAVAILABLE, "Unavailable", "details"));
+  EXPECT_EQ(converted.code(), gax::StatusCode::kUnavailable);
+  EXPECT_EQ(converted.error_details(), "details");
+}
+
+TEST(Status, Assignment) {
+  gax::Status status;
+  gax::Status cancelled(gax::StatusCode::kCancelled, "Because", "details");
+  status = cancelled;
+  EXPECT_EQ(status, cancelled);
+  EXPECT_EQ(status.error_details(), "details");
+
+  status = gax::Status();
+  EXPECT_TRUE(status.IsOk());
+  EXPECT_EQ(status.message(), "");
+
+  status = std::move(cancelled);
+  EXPECT_EQ(status.code(), gax::StatusCode::kCancelled);
+  EXPECT_EQ(status.message(), "Because");
+  EXPECT_EQ(status.error_details(), "details");
+}
+
+TEST(Status, Vector) {
+  std::vector<gax::Status> statuses;
+  for (int i = 0; i != 100; ++i) {
+    statuses.emplace_back(gax::StatusCode::kUnavailable,
+                          "Unavailable " + std::to_string(i));
+  }
+  EXPECT_EQ(statuses[42].message(), "Unavailable 42");
+  statuses.erase(statuses.begin());
+  EXPECT_EQ(statuses[42].message(), "Unavailable 43");
+}
+
 }  // namespace
@@ -37,7 +37,8 @@ std::vector<std::string> BuildClientCCIncludes(
       LocalInclude(
           absl::StrCat(internal::ServiceNameToFilePath(service->full_name()),
                        "_stub.gapic.h")),
-      LocalInclude("gax/call_context.h"), LocalInclude("gax/status.h"),
+      LocalInclude("gax/call_context.h"),
+      LocalInclude("gax/routing_header.h"), LocalInclude("gax/status.h"),
       LocalInclude("gax/status_or.h"),
   };
 }
@@ -72,25 +73,69 @@ bool GenerateClientCC(pb::ServiceDescriptor const* service,
       "google::gax::StatusOr<$response_object$>\n"
       "$class_name$::$method_name$(\n"
       "$request_object$ const& request) {\n"
+      // The response is filled inside the returned StatusOr, which is then
+      // eligible for NRVO, so the message is never copied.
+      "  google::gax::StatusOr<$response_object$> result(\n"
+      "      google::gax::kInPlace);\n"
+      "  google::gax::Status status = $method_name$(request, &*result);\n"
+      "  if (!status.IsOk()) {\n"
+      "    result = std::move(status);\n"
+      "  }\n"
+      "  return result;\n"
+      "}\n"
+      "\n"
+      "google::gax::Status\n"
+      "$class_name$::$method_name$(\n"
+      "$request_object$ const& request,\n"
+      "    $response_object$* response) {\n"
       "  google::gax::CallContext context($method_name_snake$_info);\n"
+      "  context.SetStaticMetadata(static_metadata_);\n"
+      "$routing_header$"
       "  if (retry_policy_) {\n"
       "    context.SetRetryPolicy(*retry_policy_);\n"
       "  }\n"
       "  if (backoff_policy_) {\n"
       "    context.SetBackoffPolicy(*backoff_policy_);\n"
       "  }\n"
-      "  $response_object$ response;\n"
-      "  google::gax::Status status = stub_->$method_name$(context, request, "
-      "&response);\n"
-      "  if (status.IsOk()) {\n"
-      "    return response;\n"
-      "  } else {\n"
+      "  if (hedging_policy_) {\n"
+      "    context.SetHedgingPolicy(*hedging_policy_);\n"
+      "  }\n"
+      "  return stub_->$method_name$(context, request, response);\n"
+      "}\n"
+      "\n"
+      "google::gax::StatusOr<$response_object$*>\n"
+      "$class_name$::$method_name$OnArena(\n"
+      "$request_object$ const& request,\n"
+      "    google::protobuf::Arena* arena) {\n"
+      "  if (arena == nullptr) {\n"
+      "    return google::gax::Status(\n"
+      "        google::gax::StatusCode::kInvalidArgument, \"null arena\");\n"
+      "  }\n"
+      "  auto* response = google::protobuf::Arena::CreateMessage<\n"
+      "      $response_object$>(arena);\n"
+      "  google::gax::Status status = $method_name$(request, response);\n"
+      "  if (!status.IsOk()) {\n"
       "    return status;\n"
       "  }\n"
+      "  return response;\n"
       "}\n"
       "\n",
       NoStreamingPredicate);
 
+  DataModel::PrintMethods(
+      service, vars, p,
+      "$class_name$::$method_name$PaginatedResult\n"
+      "$class_name$::$method_name$Range(\n"
+      "$request_object$ request,\n"
+      "    google::gax::PagesOptions options) {\n"
+      "  $method_name$Retriever retriever(this, std::move(request),\n"
+      "      options.page_size_controller);\n"
+      "  return $method_name$PaginatedResult(std::move(retriever), 0,\n"
+      "      std::move(options));\n"
+      "}\n"
+      "\n",
+      PaginatedPredicate);
+
   DataModel::PrintMethods(service, vars, p,
                           "constexpr google::gax::MethodInfo "
                           "$class_name$::$method_name_snake$_info;\n",
@@ -30,16 +30,26 @@ namespace internal {
 
 std::vector<std::string> BuildClientHeaderIncludes(
     pb::ServiceDescriptor const* service) {
-  return {
+  std::vector<std::string> includes = {
       SystemInclude("memory"),
       LocalInclude(absl::StrCat(
           internal::ServiceNameToFilePath(service->name()), "_stub.gapic.h")),
       LocalInclude(absl::StrCat(
           absl::StripSuffix(service->file()->name(), ".proto"), ".pb.h")),
+      LocalInclude("google/protobuf/arena.h"),
 
+      LocalInclude("gax/call_context.h"),
       LocalInclude("gax/status_or.h"), LocalInclude("gax/retry_policy.h"),
       LocalInclude("gax/backoff_policy.h"),
+      LocalInclude("gax/hedging_policy.h"),
   };
+  for (int i = 0; i < service->method_count(); i++) {
+    if (PaginatedPredicate(service->method(i))) {
+      includes.push_back(LocalInclude("gax/pagination.h"));
+      break;
+    }
+  }
+  return includes;
 }
 
 std::vector<std::string> BuildClientHeaderNamespaces(
@@ -75,35 +85,108 @@ bool GenerateClientHeader(pb::ServiceDescriptor const* service,
            "class $class_name$ final {\n"
            " public:\n"
            "  $class_name$(std::shared_ptr<$stub_class_name$> stub) : \n"
-           "    stub_(std::move(stub)) {}\n"
+           "    stub_(std::move(stub)),\n"
+           "    static_metadata_(google::gax::DefaultStaticMetadata()) {}\n"
            "\n"
            "  template<typename... Policies>\n"
            "  $class_name$(std::shared_ptr<$stub_class_name$> stub, \n"
            "    Policies&&... policies) : $class_name$(std::move(stub)) {\n"
-           "    ChangePolicies(std::forward<policies>...);\n"
+           "    ChangePolicies(std::forward<Policies>(policies)...);\n"
            "  }\n"
            "\n"
            "  $class_name$($class_name$ const&) = delete;\n"
            "  $class_name$& operator=($class_name$ const&) = delete;\n"
            "\n"
            "  std::shared_ptr<$stub_class_name$> Stub() { return stub_; }\n"
+           "\n"
+           "  // Replaces the policy of that kind used by every later call.\n"
+           "  void ChangePolicy(google::gax::RetryPolicy const& policy) {\n"
+           "    retry_policy_ = policy.clone();\n"
+           "  }\n"
+           "  void ChangePolicy(google::gax::BackoffPolicy const& policy) {\n"
+           "    backoff_policy_ = policy.clone();\n"
+           "  }\n"
+           "  void ChangePolicy(google::gax::HedgingPolicy const& policy) {\n"
+           "    hedging_policy_ = policy.clone();\n"
+           "  }\n"
            "\n");
 
   DataModel::PrintMethods(service, vars, p,
                           "  google::gax::StatusOr<$response_object$> \n"
                           "  $method_name$($request_object$ const& request);\n"
+                          "\n"
+                          "  // Reuses the storage of a caller-owned response "
+                          "across calls.\n"
+                          "  // On failure its contents are unspecified.\n"
+                          "  google::gax::Status \n"
+                          "  $method_name$($request_object$ const& request,\n"
+                          "      $response_object$* response);\n"
+                          "\n"
+                          "  // Allocates the response on @p arena, which owns "
+                          "it, so deep\n"
+                          "  // responses are freed in bulk with the arena. "
+                          "Fails with\n"
+                          "  // kInvalidArgument if @p arena is null.\n"
+                          "  google::gax::StatusOr<$response_object$*> \n"
+                          "  $method_name$OnArena($request_object$ const& "
+                          "request,\n"
+                          "      google::protobuf::Arena* arena);\n"
                           "\n",
                           NoStreamingPredicate);
 
+  DataModel::PrintMethods(
+      service, vars, p,
+      "  // The element accessor and page retriever of $method_name$Range().\n"
+      "  struct $method_name$Accessor {\n"
+      "    google::protobuf::RepeatedPtrField<$element_object$>*\n"
+      "    operator()($response_object$& page) const {\n"
+      "      return page.mutable_$element_field$();\n"
+      "    }\n"
+      "  };\n"
+      "\n"
+      "  class $method_name$Retriever {\n"
+      "   public:\n"
+      "    $method_name$Retriever($class_name$* client,\n"
+      "        $request_object$ request,\n"
+      "        std::shared_ptr<google::gax::AdaptivePageSize> page_size)\n"
+      "      : client_(client), request_(std::move(request)),\n"
+      "        page_size_(std::move(page_size)) {}\n"
+      "\n"
+      "    google::gax::Status operator()($response_object$* page) {\n"
+      "      if (page_size_) {\n"
+      "        request_.set_page_size(page_size_->PageSize());\n"
+      "      }\n"
+      "      google::gax::Status status =\n"
+      "          client_->$method_name$(request_, page);\n"
+      "      if (status.IsOk()) {\n"
+      "        request_.set_page_token(page->next_page_token());\n"
+      "      }\n"
+      "      return status;\n"
+      "    }\n"
+      "\n"
+      "   private:\n"
+      "    $class_name$* client_;\n"
+      "    $request_object$ request_;\n"
+      "    std::shared_ptr<google::gax::AdaptivePageSize> page_size_;\n"
+      "  };\n"
+      "\n"
+      "  using $method_name$PaginatedResult = google::gax::PaginatedResult<\n"
+      "      $element_object$, $response_object$,\n"
+      "      $method_name$Accessor, $method_name$Retriever>;\n"
+      "\n"
+      "  // Iterates over the $element_field$ of every page, fetching each "
+      "page when\n"
+      "  // the iteration reaches it. The client must outlive the result.\n"
+      "  $method_name$PaginatedResult \n"
+      "  $method_name$Range($request_object$ request,\n"
+      "      google::gax::PagesOptions options = "
+      "google::gax::PagesOptions());\n"
+      "\n",
+      PaginatedPredicate);
+
   p->Print(vars,
            "\n"
            " private:\n"
-           "  void ChangePolicy(google::gax::RetryPolicy const& policy) {\n"
-           "    retry_policy_ = policy.clone();\n"
-           "  }\n"
-           "  void ChangePolicy(google::gax::BackoffPolicy const& policy) {\n"
-           "    backoff_policy_ = policy.clone();\n"
-           "  }\n"
            "  void ChangePolicies() {}\n"
            "\n"
            "  template <typename Policy, typename... Policies>\n"
@@ -115,16 +198,20 @@ bool GenerateClientHeader(pb::ServiceDescriptor const* service,
            "  std::shared_ptr<$stub_class_name$> stub_;\n"
            "  std::unique_ptr<google::gax::RetryPolicy> retry_policy_;\n"
            "  std::unique_ptr<google::gax::BackoffPolicy> backoff_policy_;\n"
+           "  std::unique_ptr<google::gax::HedgingPolicy> hedging_policy_;\n"
+           "  // Headers sent with every call, built once and shared.\n"
+           "  std::shared_ptr<google::gax::StaticMetadata const> const\n"
+           "      static_metadata_;\n"
            "\n"
-           "  // Note: conservatively assume no methods are idempotent.\n"
-           "  //       This will eventually be set from annotations.\n");
+           "  // Note: methods are only idempotent if their idempotency_level\n"
+           "  //       option says so.\n");
 
   DataModel::PrintMethods(
       service, vars, p,
       "  static constexpr google::gax::MethodInfo $method_name_snake$_info = {"
       "\n"
       "      \"$method_name$\", google::gax::MethodInfo::RpcType::NORMAL_RPC,\n"
-      "      google::gax::MethodInfo::Idempotency::NON_IDEMPOTENT};\n",
+      "      google::gax::MethodInfo::Idempotency::$method_idempotency$};\n",
       NoStreamingPredicate);
 
   p->Print(vars,
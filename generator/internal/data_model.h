@@ -18,6 +18,7 @@
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/str_split.h"
+#include "google/api/annotations.pb.h"
 #include "google/api/client.pb.h"
 #include "generator/internal/gapic_utils.h"
 #include "generator/internal/printer.h"
@@ -28,6 +29,7 @@
 #include <cctype>
 #include <functional>
 #include <string>
+#include <vector>
 
 namespace pb = google::protobuf;
 
@@ -59,6 +61,92 @@ struct DataModel {
         internal::ProtoNameToCppName(method->input_type()->full_name());
     vars["response_object"] =
         internal::ProtoNameToCppName(method->output_type()->full_name());
+    switch (method->options().idempotency_level()) {
+      case pb::MethodOptions::NO_SIDE_EFFECTS:
+      case pb::MethodOptions::IDEMPOTENT:
+        vars["method_idempotency"] = "IDEMPOTENT";
+        break;
+      default:
+        vars["method_idempotency"] = "NON_IDEMPOTENT";
+        break;
+    }
+    vars["routing_header"] = RoutingHeaderCode(method);
+    auto const* elements = PaginatedElementField(method);
+    if (elements) {
+      vars["element_field"] = elements->lowercase_name();
+      vars["element_object"] =
+          elements->type() == pb::FieldDescriptor::TYPE_STRING
+              ? "std::string"
+              : internal::ProtoNameToCppName(
+                    elements->message_type()->full_name());
+    }
+  }
+
+  /**
+   * The code that sends the request fields bound in the method's http
+   * annotation as the routing header, so the frontend can send the call
+   * straight to the backend owning the resource.
+   *
+   * Only singular string fields are sent; the generated code is empty if
+   * there are none.
+   */
+  static std::string RoutingHeaderCode(pb::MethodDescriptor const* method) {
+    if (!method->options().HasExtension(google::api::http)) {
+      return "";
+    }
+    auto const& rule = method->options().GetExtension(google::api::http);
+    std::string path;
+    switch (rule.pattern_case()) {
+      case google::api::HttpRule::kGet:
+        path = rule.get();
+        break;
+      case google::api::HttpRule::kPut:
+        path = rule.put();
+        break;
+      case google::api::HttpRule::kPost:
+        path = rule.post();
+        break;
+      case google::api::HttpRule::kDelete:
+        path = rule.delete_();
+        break;
+      case google::api::HttpRule::kPatch:
+        path = rule.patch();
+        break;
+      case google::api::HttpRule::kCustom:
+        path = rule.custom().path();
+        break;
+      default:
+        return "";
+    }
+
+    std::string code;
+    for (auto const& variable : PathTemplateVariables(path)) {
+      std::vector<std::string> parts = absl::StrSplit(variable, '.');
+      std::string accessor = "request";
+      pb::Descriptor const* message = method->input_type();
+      pb::FieldDescriptor const* field = nullptr;
+      for (auto const& part : parts) {
+        field = message ? message->FindFieldByName(part) : nullptr;
+        if (!field || field->is_repeated()) {
+          field = nullptr;
+          break;
+        }
+        absl::StrAppend(&accessor, ".", part, "()");
+        message = field->message_type();
+      }
+      if (!field || field->type() != pb::FieldDescriptor::TYPE_STRING) {
+        continue;
+      }
+      absl::StrAppend(
+          &code, "  google::gax::AppendRoutingParam(routing_params.get(), \"",
+          variable, "\",\n      ", accessor, ");\n");
+    }
+    if (code.empty()) {
+      return "";
+    }
+    return absl::StrCat(
+        "  auto routing_params = google::gax::RoutingHeaderBuffer();\n", code,
+        "  context.SetRoutingHeader(std::move(routing_params));\n");
   }
 
   static void PrintMethods(
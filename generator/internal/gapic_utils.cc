@@ -14,6 +14,7 @@
 
 #include "generator/internal/gapic_utils.h"
 #include <string>
+#include <vector>
 
 namespace google {
 namespace api {
@@ -32,6 +33,49 @@ bool NoStreamingPredicate(pb::MethodDescriptor const* m) {
   return !m->client_streaming() && !m->server_streaming();
 }
 
+namespace {
+bool HasField(pb::Descriptor const* message, std::string const& name,
+              pb::FieldDescriptor::Type type) {
+  auto const* field = message->FindFieldByName(name);
+  return field && !field->is_repeated() && field->type() == type;
+}
+}  // namespace
+
+pb::FieldDescriptor const* PaginatedElementField(
+    pb::MethodDescriptor const* m) {
+  if (!NoStreamingPredicate(m)) {
+    return nullptr;
+  }
+  auto const* request = m->input_type();
+  auto const* response = m->output_type();
+  if (!HasField(request, "page_token", pb::FieldDescriptor::TYPE_STRING) ||
+      !HasField(request, "page_size", pb::FieldDescriptor::TYPE_INT32) ||
+      !HasField(response, "next_page_token",
+                pb::FieldDescriptor::TYPE_STRING)) {
+    return nullptr;
+  }
+  pb::FieldDescriptor const* elements = nullptr;
+  for (int i = 0; i < response->field_count(); ++i) {
+    auto const* field = response->field(i);
+    if (!field->is_repeated()) {
+      continue;
+    }
+    if (elements || field->is_map()) {
+      return nullptr;
+    }
+    elements = field;
+  }
+  if (!elements || (elements->type() != pb::FieldDescriptor::TYPE_MESSAGE &&
+                    elements->type() != pb::FieldDescriptor::TYPE_STRING)) {
+    return nullptr;
+  }
+  return elements;
+}
+
+bool PaginatedPredicate(pb::MethodDescriptor const* m) {
+  return PaginatedElementField(m) != nullptr;
+}
+
 std::string CamelCaseToSnakeCase(std::string const& input) {
   std::string output;
   for (auto i = 0u; i < input.size(); ++i) {
@@ -64,6 +108,20 @@ std::string ProtoNameToCppName(std::string const& proto_name) {
   return "::" + absl::StrReplaceAll(proto_name, {{".", "::"}});
 }
 
+std::vector<std::string> PathTemplateVariables(std::string const& path) {
+  std::vector<std::string> variables;
+  std::string::size_type pos = 0;
+  while ((pos = path.find('{', pos)) != std::string::npos) {
+    auto end = path.find_first_of("=}", pos);
+    if (end == std::string::npos) {
+      break;
+    }
+    variables.emplace_back(path.substr(pos + 1, end - pos - 1));
+    pos = end;
+  }
+  return variables;
+}
+
 }  // namespace internal
 }  // namespace codegen
 }  // namespace api
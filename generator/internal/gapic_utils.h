@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <cctype>
 #include <string>
+#include <vector>
 
 namespace google {
 namespace api {
@@ -32,6 +33,19 @@ namespace pb = google::protobuf;
 
 bool NoStreamingPredicate(pb::MethodDescriptor const* m);
 
+/**
+ * Find the repeated field holding the elements of a paginated method.
+ *
+ * A method is paginated if it is not streaming, its request has a string
+ * `page_token` and an int32 `page_size` field, and its response has a string
+ * `next_page_token` and exactly one repeated field, of message or string type.
+ *
+ * @return the repeated field, or null if the method is not paginated.
+ */
+pb::FieldDescriptor const* PaginatedElementField(pb::MethodDescriptor const* m);
+
+bool PaginatedPredicate(pb::MethodDescriptor const* m);
+
 // Convenience functions for wrapping include headers with the correct
 // delimiting characters (either <> or "")
 std::string LocalInclude(std::string header);
@@ -62,6 +76,13 @@ std::string ServiceNameToFilePath(std::string const& service_name);
  */
 std::string ProtoNameToCppName(std::string const& proto_name);
 
+/**
+ * Extract the field paths bound by the variables of an http path template.
+ *
+ * Example: "/v1/{name=shelves/1}/books/{book.id}" -> {"name", "book.id"}
+ */
+std::vector<std::string> PathTemplateVariables(std::string const& path);
+
 }  // namespace internal
 }  // namespace codegen
 }  // namespace api
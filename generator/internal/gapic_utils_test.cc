@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "generator/internal/gapic_utils.h"
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
 #include <string>
 #include <utility>
@@ -39,6 +41,109 @@ TEST(GapicUtils, CamelCaseToSnakeCase) {
   }
 }
 
+TEST(GapicUtils, PathTemplateVariables) {
+  std::vector<std::pair<std::string, std::vector<std::string>>> test_cases{
+      {"/v1/books", {}},
+      {"/v1/{name=bookShelves/*/books/*}", {"name"}},
+      {"/v1/{name=bookShelves/*}/books", {"name"}},
+      {"/v1/{shelf}/books/{book.id=*}:big", {"shelf", "book.id"}},
+      {"/v1/{unterminated", {}}};
+
+  for (auto const& test_case : test_cases) {
+    EXPECT_EQ(test_case.second, PathTemplateVariables(test_case.first))
+        << test_case.first;
+  }
+}
+
+TEST(GapicUtils, PaginatedElementField) {
+  char const kFile[] = R"pb(
+    name: "paginated.proto"
+    package: "test"
+    message_type {
+      name: "ListRequest"
+      field { name: "page_size" number: 1 type: TYPE_INT32 }
+      field { name: "page_token" number: 2 type: TYPE_STRING }
+    }
+    message_type {
+      name: "ListResponse"
+      field {
+        name: "items"
+        number: 1
+        label: LABEL_REPEATED
+        type: TYPE_MESSAGE
+        type_name: ".test.ListRequest"
+      }
+      field { name: "next_page_token" number: 2 type: TYPE_STRING }
+    }
+    message_type {
+      name: "NamesResponse"
+      field { name: "names" number: 1 label: LABEL_REPEATED type: TYPE_STRING }
+      field { name: "next_page_token" number: 2 type: TYPE_STRING }
+    }
+    message_type {
+      name: "TwoListsResponse"
+      field { name: "names" number: 1 label: LABEL_REPEATED type: TYPE_STRING }
+      field { name: "ids" number: 2 label: LABEL_REPEATED type: TYPE_STRING }
+      field { name: "next_page_token" number: 3 type: TYPE_STRING }
+    }
+    message_type {
+      name: "NumbersResponse"
+      field { name: "numbers" number: 1 label: LABEL_REPEATED type: TYPE_INT32 }
+      field { name: "next_page_token" number: 2 type: TYPE_STRING }
+    }
+    service {
+      name: "Service"
+      method {
+        name: "List"
+        input_type: ".test.ListRequest"
+        output_type: ".test.ListResponse"
+      }
+      method {
+        name: "ListNames"
+        input_type: ".test.ListRequest"
+        output_type: ".test.NamesResponse"
+      }
+      method {
+        name: "StreamList"
+        input_type: ".test.ListRequest"
+        output_type: ".test.ListResponse"
+        server_streaming: true
+      }
+      method {
+        name: "NoToken"
+        input_type: ".test.ListResponse"
+        output_type: ".test.ListResponse"
+      }
+      method {
+        name: "TwoLists"
+        input_type: ".test.ListRequest"
+        output_type: ".test.TwoListsResponse"
+      }
+      method {
+        name: "Numbers"
+        input_type: ".test.ListRequest"
+        output_type: ".test.NumbersResponse"
+      }
+    }
+  )pb";
+  pb::FileDescriptorProto file;
+  ASSERT_TRUE(pb::TextFormat::ParseFromString(kFile, &file));
+  pb::DescriptorPool pool;
+  auto const* service = pool.BuildFile(file)->service(0);
+
+  auto const* field = PaginatedElementField(service->method(0));
+  ASSERT_NE(field, nullptr);
+  EXPECT_EQ(field->name(), "items");
+  field = PaginatedElementField(service->method(1));
+  ASSERT_NE(field, nullptr);
+  EXPECT_EQ(field->name(), "names");
+
+  for (int i = 2; i < service->method_count(); ++i) {
+    EXPECT_FALSE(PaginatedPredicate(service->method(i)))
+        << service->method(i)->name();
+  }
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace codegen
@@ -33,7 +33,10 @@ std::vector<std::string> BuildClientStubCCIncludes(
                        "_stub.gapic.h")),
       LocalInclude(absl::StrCat(
           absl::StripSuffix(service->file()->name(), ".proto"), ".grpc.pb.h")),
-      LocalInclude("gax/call_context.h"), LocalInclude("gax/retry_loop.h"),
+      LocalInclude("gax/call_context.h"),
+      LocalInclude("gax/circuit_breaker.h"),
+      LocalInclude("gax/completion_queue.h"),
+      LocalInclude("gax/hedged_call.h"), LocalInclude("gax/retry_loop.h"),
       LocalInclude("gax/status.h"), LocalInclude("grpcpp/client_context.h"),
       LocalInclude("grpcpp/channel.h"), LocalInclude("grpcpp/create_channel.h"),
       SystemInclude("chrono"), SystemInclude("thread")};
@@ -76,6 +79,17 @@ bool GenerateClientStubCC(pb::ServiceDescriptor const* service,
       "  return google::gax::Status(google::gax::StatusCode::kUnimplemented,\n"
       "    \"$method_name$ not implemented\");\n"
       "}\n"
+      "\n"
+      "void\n"
+      "$stub_class_name$::Async$method_name$(\n"
+      "  google::gax::CallContext&,\n"
+      "  $request_object$ const&,\n"
+      "  $response_object$*,\n"
+      "  grpc::CompletionQueue*,\n"
+      "  std::function<void(google::gax::Status)> done) {\n"
+      "  done(google::gax::Status(google::gax::StatusCode::kUnimplemented,\n"
+      "    \"Async$method_name$ not implemented\"));\n"
+      "}\n"
       "\n",
       NoStreamingPredicate);
 
@@ -107,9 +121,24 @@ bool GenerateClientStubCC(pb::ServiceDescriptor const* service,
       "    $response_object$* response) override {\n"
       "    grpc::ClientContext grpc_ctx;\n"
       "    context.PrepareGrpcContext(&grpc_ctx);\n"
+      "    auto cancellation = context.BindCancellation(&grpc_ctx);\n"
       "    return google::gax::GrpcStatusToGaxStatus("
       "grpc_stub_->$method_name$(&grpc_ctx, request, response));\n"
       "  }\n"
+      "\n"
+      "  void\n"
+      "  Async$method_name$(google::gax::CallContext& context,\n"
+      "    $request_object$ const& request,\n"
+      "    $response_object$* response,\n"
+      "    grpc::CompletionQueue* cq,\n"
+      "    std::function<void(google::gax::Status)> done) override {\n"
+      "    // The completion queue owns the rpc once it has started.\n"
+      "    auto* rpc = new google::gax::AsyncUnaryRpc<$response_object$>(\n"
+      "        std::move(done));\n"
+      "    rpc->Prepare(context);\n"
+      "    rpc->Start(grpc_stub_->PrepareAsync$method_name$(\n"
+      "        rpc->grpc_context(), request, cq), response);\n"
+      "  }\n"
       "\n",
       NoStreamingPredicate);
 
@@ -127,10 +156,13 @@ bool GenerateClientStubCC(pb::ServiceDescriptor const* service,
            "                          google::gax::RetryPolicy const& "
            "retry_policy,\n"
            "                          google::gax::BackoffPolicy const& "
-           "backoff_policy) :\n"
+           "backoff_policy,\n"
+           "                          "
+           "std::shared_ptr<google::gax::RetryBudget> retry_budget) :\n"
            "            next_stub_(std::move(stub)),\n"
            "            default_retry_policy_(retry_policy.clone()),\n"
-           "            default_backoff_policy_(backoff_policy.clone()) {}\n"
+           "            default_backoff_policy_(backoff_policy.clone()),\n"
+           "            retry_budget_(std::move(retry_budget)) {}\n"
            "\n");
 
   DataModel::PrintMethods(
@@ -139,6 +171,24 @@ bool GenerateClientStubCC(pb::ServiceDescriptor const* service,
       "  $method_name$(google::gax::CallContext& context,\n"
       "             $request_object$ const& request,\n"
       "             $response_object$* response) override {\n"
+      "    auto hedging_policy = clone_hedging(context);\n"
+      "    if (hedging_policy) {\n"
+      "      auto invoke_async = [this](google::gax::CallContext& c,\n"
+      "                  $request_object$ const& req,\n"
+      "                  $response_object$* resp,\n"
+      "                  grpc::CompletionQueue* q,\n"
+      "                  std::function<void(google::gax::Status)> d) {\n"
+      "                this->next_stub_->Async$method_name$(c, req, resp, q,\n"
+      "                    std::move(d));\n"
+      "              };\n"
+      "      return google::gax::MakeHedgedCall<$request_object$,\n"
+      "                                         $response_object$,\n"
+      "                                         decltype(invoke_async)>(\n"
+      "          context, request, response, std::move(invoke_async),\n"
+      "          clone_retry(context), std::move(hedging_policy),\n"
+      "          retry_budget_.get());\n"
+      "    }\n"
+      "\n"
       "    auto invoke_stub = [this](google::gax::CallContext& c,\n"
       "                $request_object$ const& req,\n"
       "                $response_object$* resp) {\n"
@@ -148,14 +198,48 @@ bool GenerateClientStubCC(pb::ServiceDescriptor const* service,
       "                                      $response_object$,\n"
       "                                      decltype(invoke_stub)>(\n"
       "        context, request, response, std::move(invoke_stub),\n"
-      "        clone_retry(context), clone_backoff(context));\n"
+      "        clone_retry(context), clone_backoff(context),\n"
+      "        retry_budget_.get());\n"
+      "  }\n"
+      "\n"
+      "  void\n"
+      "  Async$method_name$(google::gax::CallContext& context,\n"
+      "             $request_object$ const& request,\n"
+      "             $response_object$* response,\n"
+      "             grpc::CompletionQueue* cq,\n"
+      "             std::function<void(google::gax::Status)> done) override {\n"
+      "    auto invoke_stub = [this](google::gax::CallContext& c,\n"
+      "                $request_object$ const& req,\n"
+      "                $response_object$* resp,\n"
+      "                grpc::CompletionQueue* q,\n"
+      "                std::function<void(google::gax::Status)> d) {\n"
+      "              this->next_stub_->Async$method_name$(c, req, resp, q,\n"
+      "                  std::move(d));\n"
+      "            };\n"
+      "    auto hedging_policy = clone_hedging(context);\n"
+      "    if (hedging_policy) {\n"
+      "      google::gax::MakeAsyncHedgedCall<$request_object$,\n"
+      "                                       $response_object$,\n"
+      "                                       decltype(invoke_stub)>(\n"
+      "          context, request, response, cq, std::move(invoke_stub),\n"
+      "          clone_retry(context), std::move(hedging_policy),\n"
+      "          std::move(done), retry_budget_.get());\n"
+      "      return;\n"
+      "    }\n"
+      "\n"
+      "    google::gax::MakeAsyncRetryCall<$request_object$,\n"
+      "                                    $response_object$,\n"
+      "                                    decltype(invoke_stub)>(\n"
+      "        context, request, response, cq, std::move(invoke_stub),\n"
+      "        clone_retry(context), clone_backoff(context),\n"
+      "        std::move(done), retry_budget_.get());\n"
       "  }\n"
       "\n",
       NoStreamingPredicate);
 
   p->Print(
       vars,
-      " private:\n"
+      " protected:\n"
       "  std::unique_ptr<google::gax::RetryPolicy>\n"
       "  clone_retry(google::gax::CallContext const &context) const {\n"
       "    auto context_retry = context.RetryPolicy();\n"
@@ -171,12 +255,167 @@ bool GenerateClientStubCC(pb::ServiceDescriptor const* service,
       "std::move(default_backoff_policy_->clone());\n"
       "  }\n"
       "\n"
+      "  // Hedging sends the same request more than once, so it is only\n"
+      "  // enabled for idempotent methods.\n"
+      "  std::unique_ptr<google::gax::HedgingPolicy>\n"
+      "  clone_hedging(google::gax::CallContext const &context) const {\n"
+      "    if (context.Info().idempotency !=\n"
+      "        google::gax::MethodInfo::Idempotency::IDEMPOTENT) {\n"
+      "      return nullptr;\n"
+      "    }\n"
+      "    return context.HedgingPolicy();\n"
+      "  }\n"
+      "\n"
       "  std::unique_ptr<$stub_class_name$> next_stub_;\n"
       "  const std::unique_ptr<google::gax::RetryPolicy const> "
       "default_retry_policy_;\n"
       "  const std::unique_ptr<google::gax::BackoffPolicy const>  "
       "default_backoff_policy_;\n"
-      "};  // Retry$stub_class_name$\n");
+      "  std::shared_ptr<google::gax::RetryBudget> retry_budget_;\n"
+      "};  // Retry$stub_class_name$\n"
+      "\n");
+
+  // Retrying stub whose default policies are known at compile time, so the
+  // common case neither clones them nor allocates. Calls that override the
+  // policies on their context, or use hedging, take the runtime path.
+  p->Print(vars,
+           "template <typename RetryPolicyT, typename BackoffPolicyT>\n"
+           "class StaticRetry$stub_class_name$ : public "
+           "Retry$stub_class_name$ {\n"
+           " public:\n"
+           "  StaticRetry$stub_class_name$("
+           "std::unique_ptr<$stub_class_name$> stub,\n"
+           "                          RetryPolicyT retry_policy,\n"
+           "                          BackoffPolicyT backoff_policy,\n"
+           "                          "
+           "std::shared_ptr<google::gax::RetryBudget> retry_budget) :\n"
+           "            Retry$stub_class_name$(std::move(stub), retry_policy,\n"
+           "                backoff_policy, std::move(retry_budget)),\n"
+           "            retry_policy_(std::move(retry_policy)),\n"
+           "            backoff_policy_(std::move(backoff_policy)) {}\n"
+           "\n");
+
+  DataModel::PrintMethods(
+      service, vars, p,
+      "  google::gax::Status\n"
+      "  $method_name$(google::gax::CallContext& context,\n"
+      "             $request_object$ const& request,\n"
+      "             $response_object$* response) override {\n"
+      "    if (context.HasPolicyOverrides()) {\n"
+      "      return Retry$stub_class_name$::$method_name$(context, request,\n"
+      "          response);\n"
+      "    }\n"
+      "\n"
+      "    auto invoke_stub = [this](google::gax::CallContext& c,\n"
+      "                $request_object$ const& req,\n"
+      "                $response_object$* resp) {\n"
+      "              return this->next_stub_->$method_name$(c, req, resp);\n"
+      "            };\n"
+      "    return google::gax::MakeRetryCall<$request_object$,\n"
+      "                                      $response_object$,\n"
+      "                                      decltype(invoke_stub)>(\n"
+      "        context, request, response, std::move(invoke_stub),\n"
+      "        retry_policy_, backoff_policy_, this->retry_budget_.get());\n"
+      "  }\n"
+      "\n",
+      NoStreamingPredicate);
+
+  p->Print(vars,
+           " private:\n"
+           "  RetryPolicyT const retry_policy_;\n"
+           "  BackoffPolicyT const backoff_policy_;\n"
+           "};  // StaticRetry$stub_class_name$\n"
+           "\n");
+
+  // Completion callback of the circuit breaking stub's async methods. A
+  // functor rather than a lambda, so `done` is moved into it, not copied.
+  p->Print(vars,
+           "class CircuitBreaker$stub_class_name$Callback {\n"
+           " public:\n"
+           "  CircuitBreaker$stub_class_name$Callback(\n"
+           "      google::gax::CircuitBreaker<>* breaker,\n"
+           "      google::gax::CircuitBreakerAdmission admission,\n"
+           "      std::function<void(google::gax::Status)> done)\n"
+           "      : breaker_(breaker), admission_(admission),\n"
+           "        done_(std::move(done)) {}\n"
+           "\n"
+           "  void operator()(google::gax::Status status) {\n"
+           "    breaker_->OnResult(admission_, status);\n"
+           "    done_(std::move(status));\n"
+           "  }\n"
+           "\n"
+           " private:\n"
+           "  google::gax::CircuitBreaker<>* breaker_;\n"
+           "  google::gax::CircuitBreakerAdmission admission_;\n"
+           "  std::function<void(google::gax::Status)> done_;\n"
+           "};\n"
+           "\n");
+
+  // Circuit breaking stub that decorates another stub, with one breaker per
+  // method.
+  p->Print(vars,
+           "class CircuitBreaker$stub_class_name$ : public $stub_class_name$ "
+           "{\n"
+           " public:\n"
+           "  CircuitBreaker$stub_class_name$("
+           "std::unique_ptr<$stub_class_name$> stub,\n"
+           "      google::gax::CircuitBreakerOptions const& options) :\n"
+           "            next_stub_(std::move(stub))");
+  DataModel::PrintMethods(service, vars, p,
+                          ",\n"
+                          "            $method_name_snake$_breaker_(options)",
+                          NoStreamingPredicate);
+  p->Print(" {}\n"
+           "\n");
+
+  DataModel::PrintMethods(
+      service, vars, p,
+      "  google::gax::Status\n"
+      "  $method_name$(google::gax::CallContext& context,\n"
+      "             $request_object$ const& request,\n"
+      "             $response_object$* response) override {\n"
+      "    auto admission = $method_name_snake$_breaker_.Allow();\n"
+      "    if (admission == "
+      "google::gax::CircuitBreakerAdmission::kRejected) {\n"
+      "      return google::gax::Status(google::gax::StatusCode::kUnavailable,"
+      "\n"
+      "          \"circuit breaker open for $method_name$\");\n"
+      "    }\n"
+      "    google::gax::Status status =\n"
+      "        next_stub_->$method_name$(context, request, response);\n"
+      "    $method_name_snake$_breaker_.OnResult(admission, status);\n"
+      "    return status;\n"
+      "  }\n"
+      "\n"
+      "  void\n"
+      "  Async$method_name$(google::gax::CallContext& context,\n"
+      "             $request_object$ const& request,\n"
+      "             $response_object$* response,\n"
+      "             grpc::CompletionQueue* cq,\n"
+      "             std::function<void(google::gax::Status)> done) override {\n"
+      "    auto admission = $method_name_snake$_breaker_.Allow();\n"
+      "    if (admission == "
+      "google::gax::CircuitBreakerAdmission::kRejected) {\n"
+      "      done(google::gax::Status(google::gax::StatusCode::kUnavailable,\n"
+      "          \"circuit breaker open for $method_name$\"));\n"
+      "      return;\n"
+      "    }\n"
+      "    next_stub_->Async$method_name$(context, request, response, cq,\n"
+      "        CircuitBreaker$stub_class_name$Callback(\n"
+      "            &$method_name_snake$_breaker_, admission, "
+      "std::move(done)));\n"
+      "  }\n"
+      "\n",
+      NoStreamingPredicate);
+
+  p->Print(vars,
+           " private:\n"
+           "  std::unique_ptr<$stub_class_name$> next_stub_;\n");
+  DataModel::PrintMethods(
+      service, vars, p,
+      "  google::gax::CircuitBreaker<> $method_name_snake$_breaker_;\n",
+      NoStreamingPredicate);
+  p->Print(vars, "};  // CircuitBreaker$stub_class_name$\n");
 
   p->Print(vars,
            "}  // namespace\n"
@@ -189,6 +428,13 @@ bool GenerateClientStubCC(pb::ServiceDescriptor const* service,
            "std::unique_ptr<$stub_class_name$>\n"
            "Create$stub_class_name$(std::shared_ptr<grpc::ChannelCredentials> "
            "creds) {\n"
+           "  return Create$stub_class_name$(std::move(creds), nullptr);\n"
+           "}\n"
+           "\n"
+           "std::unique_ptr<$stub_class_name$>\n"
+           "Create$stub_class_name$(std::shared_ptr<grpc::ChannelCredentials> "
+           "creds,\n"
+           "    std::shared_ptr<google::gax::RetryBudget> retry_budget) {\n"
            "  auto channel = grpc::CreateChannel(\"$service_endpoint$\",\n"
            "    std::move(creds));\n"
            "  auto grpc_stub = $grpc_stub_fqn$::NewStub(std::move(channel));\n"
@@ -202,10 +448,22 @@ bool GenerateClientStubCC(pb::ServiceDescriptor const* service,
            "  google::gax::ExponentialBackoffPolicy backoff_policy(ms(20), "
            "ms(100));\n"
            "  return std::unique_ptr<$stub_class_name$>(new "
-           "Retry$stub_class_name$(\n"
+           "StaticRetry$stub_class_name$<\n"
+           "                       google::gax::LimitedDurationRetryPolicy<>,\n"
+           "                       google::gax::ExponentialBackoffPolicy>(\n"
            "                       std::move(default_stub),\n"
            "                       retry_policy,\n"
-           "                       backoff_policy));\n"
+           "                       backoff_policy,\n"
+           "                       std::move(retry_budget)));\n"
+           "}\n"
+           "\n"
+           "std::unique_ptr<$stub_class_name$>\n"
+           "CreateCircuitBreaker$stub_class_name$(\n"
+           "    std::unique_ptr<$stub_class_name$> stub,\n"
+           "    google::gax::CircuitBreakerOptions const& options) {\n"
+           "  return std::unique_ptr<$stub_class_name$>(\n"
+           "      new CircuitBreaker$stub_class_name$(std::move(stub), "
+           "options));\n"
            "}\n"
            "\n");
 
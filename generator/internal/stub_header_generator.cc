@@ -31,9 +31,12 @@ std::vector<std::string> BuildClientStubHeaderIncludes(
     pb::ServiceDescriptor const* service) {
   return {LocalInclude(absl::StrCat(
               absl::StripSuffix(service->file()->name(), ".proto"), ".pb.h")),
-          LocalInclude("gax/call_context.h"), LocalInclude("gax/status.h"),
+          LocalInclude("gax/call_context.h"),
+          LocalInclude("gax/circuit_breaker.h"),
+          LocalInclude("gax/retry_budget.h"), LocalInclude("gax/status.h"),
+          LocalInclude("grpcpp/completion_queue.h"),
           LocalInclude("grpcpp/security/credentials.h"),
-          SystemInclude("memory")};
+          SystemInclude("functional"), SystemInclude("memory")};
 }
 
 std::vector<std::string> BuildClientStubHeaderNamespaces(
@@ -78,6 +81,19 @@ bool GenerateClientStubHeader(pb::ServiceDescriptor const* service,
                           "\n",
                           NoStreamingPredicate);
 
+  // Asynchronous variants. The caller drives the completion queue and must
+  // keep the request and response alive until the callback runs.
+  DataModel::PrintMethods(
+      service, vars, p,
+      "  virtual void Async$method_name$("
+      "google::gax::CallContext& context,\n"
+      "    $request_object$ const& request,\n"
+      "    $response_object$* response,\n"
+      "    grpc::CompletionQueue* cq,\n"
+      "    std::function<void(google::gax::Status)> done);\n"
+      "\n",
+      NoStreamingPredicate);
+
   p->Print(vars,
            "  virtual ~$stub_class_name$() = 0;\n"
            "\n"
@@ -90,6 +106,21 @@ bool GenerateClientStubHeader(pb::ServiceDescriptor const* service,
            "Create$stub_class_name$(std::shared_ptr<grpc::ChannelCredentials> "
            "creds);\n"
            "\n"
+           "// Retries of all the stubs sharing `retry_budget` are limited by "
+           "it.\n"
+           "std::unique_ptr<$stub_class_name$>\n"
+           "Create$stub_class_name$(std::shared_ptr<grpc::ChannelCredentials> "
+           "creds,\n"
+           "    std::shared_ptr<google::gax::RetryBudget> retry_budget);\n"
+           "\n"
+           "// Each method of the returned stub fails fast with kUnavailable "
+           "while\n"
+           "// most of its recent calls through `stub` have failed.\n"
+           "std::unique_ptr<$stub_class_name$>\n"
+           "CreateCircuitBreaker$stub_class_name$(\n"
+           "    std::unique_ptr<$stub_class_name$> stub,\n"
+           "    google::gax::CircuitBreakerOptions const& options);\n"
+           "\n"
            "#endif  // $stub_header_include_guard_const$\n");
 
   return true;
@@ -0,0 +1,111 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/example/library/v1/library_service.gapic.h"
+#include "google/example/library/v1/library_service_stub.gapic.h"
+#include "google/protobuf/arena.h"
+#include "gax/call_context.h"
+#include "gax/hedging_policy.h"
+#include "gax/retry_policy.h"
+#include "gax/status.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+
+namespace {
+
+namespace library = ::google::example::library::v1;
+
+// Answers GetBook() in process and keeps the hedging policy of the last call.
+class FakeLibraryServiceStub : public LibraryServiceStub {
+ public:
+  google::gax::Status GetBook(google::gax::CallContext& context,
+                              library::GetBookRequest const& request,
+                              library::Book* response) override {
+    hedging_policy_ = context.HedgingPolicy();
+    response->set_name(request.name());
+    return google::gax::Status();
+  }
+
+  google::gax::HedgingPolicy const* hedging_policy() const {
+    return hedging_policy_.get();
+  }
+
+ private:
+  std::unique_ptr<google::gax::HedgingPolicy> hedging_policy_;
+};
+
+library::GetBookRequest MakeRequest() {
+  library::GetBookRequest request;
+  request.set_name("shelves/1/books/2");
+  return request;
+}
+
+TEST(LibraryService, NoHedgingByDefault) {
+  auto stub = std::make_shared<FakeLibraryServiceStub>();
+  LibraryService client(stub);
+
+  auto book = client.GetBook(MakeRequest());
+  ASSERT_TRUE(book.ok());
+  EXPECT_EQ(book->name(), "shelves/1/books/2");
+  EXPECT_EQ(stub->hedging_policy(), nullptr);
+}
+
+TEST(LibraryService, HedgingPolicyInConstructor) {
+  auto stub = std::make_shared<FakeLibraryServiceStub>();
+  LibraryService client(
+      stub, google::gax::LimitedErrorCountRetryPolicy<>(
+                3, std::chrono::milliseconds(100)),
+      google::gax::FixedDelayHedgingPolicy(2, std::chrono::milliseconds(5)));
+
+  auto book = client.GetBook(MakeRequest());
+  ASSERT_TRUE(book.ok());
+  ASSERT_NE(stub->hedging_policy(), nullptr);
+  EXPECT_EQ(stub->hedging_policy()->MaxHedgedAttempts(), 2);
+  EXPECT_EQ(stub->hedging_policy()->HedgingDelay(),
+            std::chrono::milliseconds(5));
+}
+
+TEST(LibraryService, ChangeHedgingPolicy) {
+  auto stub = std::make_shared<FakeLibraryServiceStub>();
+  LibraryService client(stub);
+  client.ChangePolicy(
+      google::gax::FixedDelayHedgingPolicy(3, std::chrono::milliseconds(1)));
+
+  auto book = client.GetBook(MakeRequest());
+  ASSERT_TRUE(book.ok());
+  ASSERT_NE(stub->hedging_policy(), nullptr);
+  EXPECT_EQ(stub->hedging_policy()->MaxHedgedAttempts(), 3);
+}
+
+TEST(LibraryService, GetBookOnArena) {
+  auto stub = std::make_shared<FakeLibraryServiceStub>();
+  LibraryService client(stub);
+  google::protobuf::Arena arena;
+
+  auto book = client.GetBookOnArena(MakeRequest(), &arena);
+  ASSERT_TRUE(book.ok());
+  EXPECT_EQ((*book)->GetArena(), &arena);
+  EXPECT_EQ((*book)->name(), "shelves/1/books/2");
+}
+
+TEST(LibraryService, GetBookOnNullArena) {
+  auto stub = std::make_shared<FakeLibraryServiceStub>();
+  LibraryService client(stub);
+
+  auto book = client.GetBookOnArena(MakeRequest(), nullptr);
+  EXPECT_EQ(book.status().code(), google::gax::StatusCode::kInvalidArgument);
+}
+
+}  // namespace